@@ -0,0 +1,508 @@
+// Benchmark of the filter on synthetic frames: FillBorders is created and its GetFrame called through the mock of the AviSynth+ API in
+// tests/mock/avisynth.h. Prints one JSON object per configuration.
+//
+// fillborders_bench [--modes 0,1,...] [--bits 8,10,16,32] [--subsampling 444,422,420] [--resolutions sd,hd,uhd,8k] [--borders 2,8,32]
+//     [--features borders,regions,mask,packed,props,autodetect] [--opt -1..3] [--threads n] [--in-place] [--core] [--min-time ms]
+//
+// ns_per_frame is the average time of one GetFrame, gb_per_s the size of the frame (all planes) filled per second. The source clip
+// returns the same frame for every request, so the filter writes to a new frame; with --in-place it returns a new copy of its frame
+// instead (filled in place), and the time of that copy, measured alone as source_ns_per_frame, is subtracted. The frames are
+// requested in order, mode 7 reads the edges of the previous frames from its cache.
+//
+// Each feature adds one parameter to the borders of the configuration:
+// - regions: a rectangle of half the width and height in the centre, with the mode (1 for mode 7) and border of the configuration;
+// - mask: a greyscale mask with a block of an eighth of the width and height in the centre and a short run every 16 rows;
+// - packed: the packed format of the bit depth and subsampling (YUY2 for 8 bit 422, RGB32 and RGB64 for 8 and 16 bit 444);
+// - props: the borders are read from the _FillBorders_* frame properties (borders_from_props);
+// - autodetect: the borders are detected, on a first plane whose outer columns and rows are black.
+//
+// --core times fillborders_core::fill alone on the planes of the frame (in place), without GetFrame, the copy of the frame and the
+// features.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <avisynth.h>
+
+#include "FillBordersCore.h"
+
+extern "C" const char* __stdcall AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors);
+
+namespace
+{
+struct resolution
+{
+    const char* name;
+    int width;
+    int height;
+};
+
+constexpr resolution all_resolutions[]{{"sd", 720, 480}, {"hd", 1920, 1080}, {"uhd", 3840, 2160}, {"8k", 7680, 4320}};
+
+constexpr const char* all_features[]{"borders", "regions", "mask", "packed", "props", "autodetect"};
+
+// Frames of the source clip, requested in order and again from the start.
+constexpr int NUM_FRAMES{1 << 20};
+
+struct options
+{
+    std::vector<int> modes{0, 1, 2, 3, 4, 5, 6, 7};
+    std::vector<int> bits{8, 10, 16, 32};
+    std::vector<int> subsampling{444, 420};
+    std::vector<std::string> resolutions{"sd", "hd", "uhd", "8k"};
+    std::vector<int> borders{2, 8, 32};
+    std::vector<std::string> features{"borders"};
+    int opt{-1};
+    int threads{1};
+    bool in_place{false};
+    bool core{false};
+    double min_time_ms{200.0};
+};
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> values;
+    size_t begin{0};
+
+    while (begin <= list.size())
+    {
+        const size_t end{std::min(list.find(',', begin), list.size())};
+
+        if (end > begin)
+            values.push_back(list.substr(begin, end - begin));
+
+        begin = end + 1;
+    }
+
+    return values;
+}
+
+std::vector<int> split_ints(const std::string& list)
+{
+    std::vector<int> values;
+
+    for (const std::string& value : split(list))
+        values.push_back(std::atoi(value.c_str()));
+
+    return values;
+}
+
+bool parse_options(const int argc, char** argv, options& opts)
+{
+    for (int i{1}; i < argc; ++i)
+    {
+        const std::string arg{argv[i]};
+        const bool has_value{i + 1 < argc};
+
+        if (arg == "--in-place")
+            opts.in_place = true;
+        else if (arg == "--core")
+            opts.core = true;
+        else if (!has_value)
+            return false;
+        else if (arg == "--modes")
+            opts.modes = split_ints(argv[++i]);
+        else if (arg == "--bits")
+            opts.bits = split_ints(argv[++i]);
+        else if (arg == "--subsampling")
+            opts.subsampling = split_ints(argv[++i]);
+        else if (arg == "--resolutions")
+            opts.resolutions = split(argv[++i]);
+        else if (arg == "--borders")
+            opts.borders = split_ints(argv[++i]);
+        else if (arg == "--features")
+            opts.features = split(argv[++i]);
+        else if (arg == "--opt")
+            opts.opt = std::atoi(argv[++i]);
+        else if (arg == "--threads")
+            opts.threads = std::atoi(argv[++i]);
+        else if (arg == "--min-time")
+            opts.min_time_ms = std::atof(argv[++i]);
+        else
+            return false;
+    }
+
+    return true;
+}
+
+// A clip of one synthetic frame: a gradient with some noise, so the fill of every mode reads varying samples.
+class synthetic_clip : public IClip
+{
+    VideoInfo m_vi;
+    PVideoFrame m_frame;
+    const bool m_copy;
+
+public:
+    size_t bytes{0};
+
+    synthetic_clip(const VideoInfo& vi, const bool copy, IScriptEnvironment* env) : m_vi(vi), m_frame(env->NewVideoFrame(vi)), m_copy(copy)
+    {
+        unsigned state{12345};
+
+        for (const int p : vi.planes())
+        {
+            const int width{m_frame->GetRowSize(p) / vi.ComponentSize()};
+            const int height{m_frame->GetHeight(p)};
+            const bool chroma{!vi.IsRGB() && (p == PLANAR_U || p == PLANAR_V)};
+            bytes += static_cast<size_t>(m_frame->GetRowSize(p)) * height;
+
+            for (int y{0}; y < height; ++y)
+            {
+                uint8_t* row{m_frame->GetWritePtr(p) + static_cast<ptrdiff_t>(y) * m_frame->GetPitch(p)};
+
+                for (int x{0}; x < width; ++x)
+                {
+                    state = state * 1664525u + 1013904223u;
+                    const double value{((x + y) % 256) / 256.0 * 0.75 + (state >> 24) / 256.0 * 0.25};
+
+                    if (vi.bits == 32)
+                    {
+                        const float sample{static_cast<float>((chroma) ? value - 0.5 : value)};
+                        std::memcpy(row + x * 4, &sample, 4);
+                    }
+                    else if (vi.bits > 8)
+                    {
+                        const uint16_t sample{static_cast<uint16_t>(value * ((1 << vi.bits) - 1))};
+                        std::memcpy(row + x * 2, &sample, 2);
+                    }
+                    else
+                        row[x] = static_cast<uint8_t>(value * 255);
+                }
+            }
+        }
+    }
+
+    // Border sizes read by borders_from_props.
+    void set_border_props(const int border)
+    {
+        for (const char* name : {"_FillBorders_Left", "_FillBorders_Top", "_FillBorders_Right", "_FillBorders_Bottom"})
+            m_frame->props.int_props[name] = {border};
+    }
+
+    // Black outer columns and rows of the first plane, found by autodetect.
+    void darken_borders(const int border)
+    {
+        const int p{m_vi.planes()[0]};
+        const int row_size{m_frame->GetRowSize(p)};
+        const int height{m_frame->GetHeight(p)};
+
+        for (int y{0}; y < height; ++y)
+        {
+            uint8_t* row{m_frame->GetWritePtr(p) + static_cast<ptrdiff_t>(y) * m_frame->GetPitch(p)};
+            const bool dark_row{y < border || y >= height - border};
+            const int dark_bytes{std::min(border * m_vi.ComponentSize(), row_size)};
+
+            std::memset(row, 0, (dark_row) ? row_size : dark_bytes);
+            std::memset(row + row_size - dark_bytes, 0, dark_bytes);
+        }
+    }
+
+    PVideoFrame __stdcall GetFrame(int, IScriptEnvironment*) override
+    {
+        return (m_copy) ? PVideoFrame{new VideoFrame(*m_frame.operator->())} : m_frame;
+    }
+
+    const VideoInfo& __stdcall GetVideoInfo() override
+    {
+        return m_vi;
+    }
+};
+
+// A clip of one greyscale 8 bit mask frame: a block in the centre and a run of 8 samples every 16 rows.
+class mask_clip : public IClip
+{
+    VideoInfo m_vi;
+    PVideoFrame m_frame;
+
+public:
+    mask_clip(const VideoInfo& vi, IScriptEnvironment* env) : m_vi(vi)
+    {
+        m_vi.bits = 8;
+        m_vi.num_components = 1;
+        m_vi.subsampling_w = m_vi.subsampling_h = 0;
+        m_vi.rgb = false;
+        m_vi.packed_bytes = 0;
+        m_vi.num_frames = 1;
+        m_frame = env->NewVideoFrame(m_vi);
+
+        for (int y{0}; y < m_vi.height; ++y)
+        {
+            uint8_t* row{m_frame->GetWritePtr(PLANAR_Y) + static_cast<ptrdiff_t>(y) * m_frame->GetPitch(PLANAR_Y)};
+            const bool block_row{y >= m_vi.height * 7 / 16 && y < m_vi.height * 9 / 16};
+            std::memset(row, 0, m_vi.width);
+
+            if (block_row)
+                std::memset(row + m_vi.width * 7 / 16, 255, m_vi.width / 8);
+
+            if (y % 16 == 0)
+                std::memset(row + (y * 37) % std::max(m_vi.width - 8, 1), 255, std::min(8, m_vi.width));
+        }
+    }
+
+    PVideoFrame __stdcall GetFrame(int, IScriptEnvironment*) override
+    {
+        return m_frame;
+    }
+
+    const VideoInfo& __stdcall GetVideoInfo() override
+    {
+        return m_vi;
+    }
+};
+
+// Average time of one call of get_frame (with the frame number): one warm-up frame, then frames until min_time has passed.
+std::pair<double, int64_t> time_frames(const options& opts, const std::function<void(int)>& get_frame)
+{
+    get_frame(0);
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start{clock::now()};
+    int64_t frames{0};
+    double elapsed_ns{0.0};
+
+    do
+    {
+        get_frame(static_cast<int>(++frames % NUM_FRAMES));
+        elapsed_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    } while (elapsed_ns < opts.min_time_ms * 1e6 || frames < 3);
+
+    return {elapsed_ns / frames, frames};
+}
+
+// Time of fillborders_core::fill on the planes of one frame of the source, filled in place.
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+double time_core(const options& opts, const VideoInfo& vi, synthetic_clip& source, const int border, IScriptEnvironment& env,
+    int64_t& frames)
+{
+    const fillborders_format format{vi.width, vi.height, vi.NumComponents(), vi.bits, vi.subsampling_w, vi.subsampling_h, vi.IsRGB()};
+    const fillborders_core<T_Pixel, T_Calc, MODE_VAL> core{
+        format, {3, 3, 3, 3}, false, 0, 1, std::nullopt, (opts.opt == -1) ? cpu_opt_level() : opts.opt, opts.threads};
+    const std::array<int, 4> sizes{derive_border_array({border}, 1, vi.subsampling_w)};
+    const std::array<int, 4> heights{derive_border_array({border}, 1, vi.subsampling_h)};
+    std::string error;
+    const auto g{core.get_geometry({sizes, {heights, heights}, sizes, {heights, heights}}, error)};
+
+    if (!g)
+        env.ThrowError("%s", error.c_str());
+
+    PVideoFrame frame{source.GetFrame(0, &env)};
+    frame_planes planes{};
+
+    for (int i{0}; i < vi.NumComponents(); ++i)
+    {
+        const int p{vi.planes()[i]};
+        planes.srcp[i] = planes.dstp[i] = frame->GetWritePtr(p);
+        planes.src_stride[i] = planes.dst_stride[i] = frame->GetPitch(p);
+    }
+
+    const auto [ns_per_frame, core_frames]{time_frames(opts, [&](int) { core.fill(*g, planes); })};
+    frames = core_frames;
+    return ns_per_frame;
+}
+
+template<typename T_Pixel, typename T_Calc>
+double time_core(const options& opts, const int mode, const VideoInfo& vi, synthetic_clip& source, const int border,
+    IScriptEnvironment& env, int64_t& frames)
+{
+    switch (mode)
+    {
+    case 0:
+        return time_core<T_Pixel, T_Calc, 0>(opts, vi, source, border, env, frames);
+    case 1:
+        return time_core<T_Pixel, T_Calc, 1>(opts, vi, source, border, env, frames);
+    case 2:
+        return time_core<T_Pixel, T_Calc, 2>(opts, vi, source, border, env, frames);
+    case 3:
+        return time_core<T_Pixel, T_Calc, 3>(opts, vi, source, border, env, frames);
+    case 4:
+        return time_core<T_Pixel, T_Calc, 4>(opts, vi, source, border, env, frames);
+    case 5:
+        return time_core<T_Pixel, T_Calc, 5>(opts, vi, source, border, env, frames);
+    case 6:
+        return time_core<T_Pixel, T_Calc, 6>(opts, vi, source, border, env, frames);
+    default:
+        env.ThrowError("mode 7 is only timed through GetFrame.");
+    }
+}
+
+// The format of the configuration, packed for the feature packed.
+VideoInfo video_info(
+    const std::string& feature, const int bits, const int subsampling, const resolution& res, IScriptEnvironment& env)
+{
+    VideoInfo vi;
+    vi.width = res.width;
+    vi.height = res.height;
+    vi.bits = bits;
+    vi.num_frames = NUM_FRAMES;
+    vi.subsampling_w = (subsampling == 444) ? 0 : 1;
+    vi.subsampling_h = (subsampling == 420) ? 1 : 0;
+
+    if (feature != "packed")
+        return vi;
+
+    if (bits == 8 && subsampling == 422)
+        vi.packed_bytes = 2;
+    else if ((bits == 8 || bits == 16) && subsampling == 444)
+    {
+        vi.rgb = true;
+        vi.num_components = 4;
+        vi.packed_bytes = (bits == 8) ? 4 : 8;
+    }
+    else
+        env.ThrowError("no packed format of this bit depth and subsampling.");
+
+    return vi;
+}
+
+// The arguments of the feature.
+std::vector<std::pair<const char*, AVSValue>> feature_args(const std::string& feature, const VideoInfo& vi, const int mode,
+    const int border, synthetic_clip& source, IScriptEnvironment& env)
+{
+    if (feature == "regions")
+    {
+        const int mod{4};
+        const AVSValue region{std::vector<AVSValue>{vi.width / 4 / mod * mod, vi.height / 4 / mod * mod, vi.width / 2 / mod * mod,
+            vi.height / 2 / mod * mod, (mode == 7) ? 1 : mode, border, border, border, border}};
+        return {{"regions", AVSValue(std::vector<AVSValue>{region})}};
+    }
+
+    if (feature == "mask")
+        return {{"mask", PClip{new mask_clip(vi, &env)}}};
+
+    if (feature == "props")
+    {
+        source.set_border_props(border);
+        return {{"borders_from_props", true}};
+    }
+
+    if (feature == "autodetect")
+    {
+        source.darken_borders(border);
+        return {{"autodetect", true}};
+    }
+
+    return {};
+}
+
+void run(IScriptEnvironment& env, const options& opts, const std::string& feature, const int mode, const int bits,
+    const int subsampling, const resolution& res, const int border)
+{
+    PClip source_clip;
+    synthetic_clip* source{};
+    PClip filter;
+    double core_ns_per_frame{};
+    int64_t core_frames{};
+
+    try
+    {
+        const VideoInfo vi{video_info(feature, bits, subsampling, res, env)};
+        source = new synthetic_clip(vi, opts.in_place, &env);
+        source_clip = source;
+
+        if (opts.core)
+        {
+            if (feature != "borders")
+                env.ThrowError("--core times the borders of planar formats only.");
+
+            core_ns_per_frame = (bits == 8)  ? time_core<uint8_t, int>(opts, mode, vi, *source, border, env, core_frames)
+                                : (bits == 32) ? time_core<float, float>(opts, mode, vi, *source, border, env, core_frames)
+                                               : time_core<uint16_t, int>(opts, mode, vi, *source, border, env, core_frames);
+        }
+        else
+        {
+            // The borders of props and autodetect come from the frames.
+            const int arg_border{(feature == "props" || feature == "autodetect") ? 0 : border};
+            std::vector<std::pair<const char*, AVSValue>> args{{nullptr, source_clip}, {"left", arg_border}, {"top", arg_border},
+                {"right", arg_border}, {"bottom", arg_border}, {"mode", mode}, {"opt", opts.opt}, {"threads", opts.threads}};
+            const std::vector<std::pair<const char*, AVSValue>> extra_args{feature_args(feature, vi, mode, border, *source, env)};
+            args.insert(args.end(), extra_args.begin(), extra_args.end());
+            filter = env.call("FillBorders", args).AsClip();
+            // Errors of the borders read from the frames.
+            filter->GetFrame(0, &env);
+        }
+    }
+    catch (const AvisynthError& error)
+    {
+        std::fprintf(stderr, "%s, mode %d, %d bit, %d, %s, border %d: %s\n", feature.c_str(), mode, bits, subsampling, res.name, border,
+            error.msg);
+        return;
+    }
+
+    const bool in_place{opts.in_place || opts.core};
+    const double source_ns_per_frame{
+        (opts.in_place && !opts.core) ? time_frames(opts, [&](const int n) { source_clip->GetFrame(n, &env); }).first : 0.0};
+    const auto [total_ns_per_frame, frames]{(opts.core) ? std::pair{core_ns_per_frame, core_frames}
+                                                        : time_frames(opts, [&](const int n) { filter->GetFrame(n, &env); })};
+    const double ns_per_frame{std::max(total_ns_per_frame - source_ns_per_frame, 1.0)};
+
+    std::printf("{\"feature\":\"%s\",\"core\":%s,\"mode\":%d,\"bits\":%d,\"subsampling\":%d,\"resolution\":\"%s\",\"width\":%d,"
+                "\"height\":%d,\"border\":%d,\"opt\":%d,\"threads\":%d,\"in_place\":%s,\"frames\":%lld,\"ns_per_frame\":%.0f,"
+                "\"source_ns_per_frame\":%.0f,\"gb_per_s\":%.3f}\n",
+        feature.c_str(), (opts.core) ? "true" : "false", mode, bits, subsampling, res.name, res.width, res.height, border, opts.opt,
+        opts.threads, (in_place) ? "true" : "false", static_cast<long long>(frames), ns_per_frame, source_ns_per_frame,
+        source->bytes / ns_per_frame);
+    std::fflush(stdout);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+
+    if (!parse_options(argc, argv, opts))
+    {
+        std::fprintf(stderr,
+            "usage: fillborders_bench [--modes 0,1,...] [--bits 8,10,16,32] [--subsampling 444,422,420] [--resolutions sd,hd,uhd,8k]\n"
+            "    [--borders 2,8,32] [--features borders,regions,mask,packed,props,autodetect] [--opt -1..3] [--threads n] [--in-place]\n"
+            "    [--core] [--min-time ms]\n");
+        return 1;
+    }
+
+    IScriptEnvironment env;
+    // New frames are not initialized, like in AviSynth+.
+    env.frame_fill = -1;
+    AvisynthPluginInit3(&env, nullptr);
+
+    for (const std::string& name : opts.resolutions)
+    {
+        const auto res{std::find_if(std::begin(all_resolutions), std::end(all_resolutions),
+            [&](const resolution& r) { return name == r.name; })};
+
+        if (res == std::end(all_resolutions))
+        {
+            std::fprintf(stderr, "unknown resolution %s\n", name.c_str());
+            return 1;
+        }
+
+        for (const std::string& feature : opts.features)
+        {
+            if (std::find(std::begin(all_features), std::end(all_features), feature) == std::end(all_features))
+            {
+                std::fprintf(stderr, "unknown feature %s\n", feature.c_str());
+                return 1;
+            }
+
+            for (const int mode : opts.modes)
+            {
+                for (const int bits : opts.bits)
+                {
+                    for (const int subsampling : opts.subsampling)
+                    {
+                        for (const int border : opts.borders)
+                            run(env, opts, feature, mode, bits, subsampling, *res, border);
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * C API of the FillBorders core: fills the borders of planar frames in memory, without AviSynth.
+ *
+ * A config is created once for the format and the border sizes and can then fill any number of frames, also from several threads at
+ * the same time. The frames are given as plane pointers and strides in bytes; a plane whose source and destination pointers are equal
+ * is filled in place, otherwise it is copied first.
+ */
+
+#ifndef FILLBORDERS_H
+#define FILLBORDERS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fb_params
+{
+    /* Format. Planes 1 and 2 are subsampled unless rgb is set. Samples are 8-16 bit integers or (bits 32) floats. */
+    int width;
+    int height;
+    int bits;
+    int num_planes;
+    int subsampling_w;
+    int subsampling_h;
+    int rgb;
+
+    /* Border sizes of every plane. top2/bottom2 are the sizes of the bottom field with interlaced, -1 for the same as top/bottom. */
+    int left[4];
+    int top[4];
+    int right[4];
+    int bottom[4];
+    int top2[4];
+    int bottom2[4];
+
+    /* Same meaning as the parameters of the AviSynth filter. process: 1 leave the plane untouched, 2 copy it, 3 fill it. */
+    int mode;
+    int process[4];
+    int interlaced;
+    int ts;
+    int ts_mode;
+    /* mode 5: fade towards fade_value (native range for integer samples, normalized for float) instead of the first row. */
+    int has_fade_value;
+    double fade_value[4];
+    /* -1 auto-detect, 0 C++, 1 SSE4.1, 2 AVX2, 3 AVX-512. */
+    int opt;
+    /* Threads used to fill one frame, 0 for all logical cores. */
+    int threads;
+} fb_params;
+
+typedef struct fb_config fb_config;
+
+/* Sets the defaults: no borders, mode 0, all planes processed, ts_mode 1, opt -1, threads 1. */
+void fb_params_init(fb_params* params);
+
+/* Validates the parameters and precomputes the fill. Returns NULL and writes the reason to error (when not NULL) on failure. */
+fb_config* fb_config_create(const fb_params* params, char* error, size_t error_size);
+
+void fb_config_free(fb_config* config);
+
+/* Fills one frame. Returns 0 on success, -1 when memory could not be allocated. */
+int fb_fill(const fb_config* config, const void* const src[4], const ptrdiff_t src_stride[4], void* const dst[4],
+    const ptrdiff_t dst_stride[4]);
+
+/*
+ * Measures the black/dirty borders of a plane: the number of outer columns/rows (up to a quarter of the plane) whose average is at
+ * most threshold (in the sample range of the plane). Writes left, top, right, bottom to borders. Returns -1 for unsupported bits.
+ */
+int fb_detect_borders(const void* plane, int width, int height, ptrdiff_t stride, int bits, double threshold, int borders[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,92 +1,86 @@
 #include <algorithm>
 #include <array>
-#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 
 #include <avisynth.h>
 
-static constexpr int TS_KERNELSIZE{5};
-static constexpr int MAX_TSIZE{10};
-
-template<typename T_Pixel>
-AVS_FORCEINLINE void memset16(T_Pixel* AVS_RESTRICT ptr, const T_Pixel value, const size_t num) noexcept
-{
-    for (size_t i{}; i < num; ++i)
-        ptr[i] = value;
-}
-
-template<typename T_Pixel, typename T_Calc>
-AVS_FORCEINLINE auto lerp(const T_Calc fill, const T_Calc src, const int pos, const int size, const int bits, const int plane)
-{
-    if constexpr (std::is_same_v<T_Pixel, uint8_t>)
-        return std::clamp((fill * 256 * pos + src * 256 * (size - pos)) / size >> 8, 0, 255);
-    else if constexpr (std::is_same_v<T_Pixel, uint16_t>)
-    {
-        const int64_t max_range{1LL << bits};
-        return static_cast<int>(
-            std::clamp((fill * max_range * pos + src * max_range * (static_cast<int64_t>(size) - pos)) / size / max_range,
-                static_cast<int64_t>(0), max_range - 1));
-    }
-    else
-        return std::clamp((fill * pos + src * (size - pos)) / size, plane ? -0.5f : 0.0f, plane ? 0.5f : 1.0f);
-}
+#include "FillBordersCore.h"
 
 template<typename T_Pixel, typename T_Calc, int MODE_VAL>
 class FillBorders : public GenericVideoFilter
 {
+    // Mode 7 (temporal) is checked and filled like mode 1 (repeat), then the borders are replaced by the filtered edges of the recent
+    // frames.
+    using core_t = fillborders_core<T_Pixel, T_Calc, (MODE_VAL == 7) ? 1 : MODE_VAL>;
+    // Border sizes of every plane and the data derived from them. Fixed for the clip, or read from the frame properties.
+    using geometry = typename core_t::geometry;
+
     const int m_subsample_shift_h;
     const int m_subsample_shift_w;
-    const std::array<int, 4> m_left;
-    const std::array<int, 4> m_top;
-    const std::array<int, 4> m_right;
-    const std::array<int, 4> m_bottom;
     const bool m_interlaced;
     const int m_ts_runtime;
-    const int m_ts_mode_runtime;
-    const std::optional<std::array<T_Calc, 4>> m_fade_target_value;
-    const std::array<int, 4> m_process;
-    const std::array<float, TS_KERNELSIZE> m_ts_kernel_data;
     const bool has_at_least_v8;
-
-    void handle_mode_0_fillmargins_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-    void handle_mode_1_repeat_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-    void handle_mode_2_mirror_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-    void handle_mode_3_reflect_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-    void handle_mode_4_wrap_base_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-    void apply_mode4_transient_smoothing_impl(T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride,
-        int component_idx, const int bits, const int lerp_plane_idx_param, T_Pixel* AVS_RESTRICT temp_buf) const noexcept;
-    void handle_mode_5_fade_impl(T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx,
-        const int bits, const int lerp_plane_idx_param) const noexcept;
-    void handle_mode_6_fixborders_impl(
-        T_Pixel* AVS_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int component_idx) const noexcept;
-
-    void smooth_lerp_left_impl(T_Pixel* AVS_RESTRICT row_ptr, int plane_width, int border_size, int tr_s, const int bits,
-        const int lerp_plane_idx_param) const noexcept;
-    void smooth_lerp_right_impl(T_Pixel* AVS_RESTRICT row_ptr, int plane_width, int border_size, int tr_s, const int bits,
-        const int lerp_plane_idx_param) const noexcept;
-    void smooth_lerp_top_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start, int plane_height, size_t stride, int border_size, int tr_s,
-        const int bits, const int lerp_plane_idx_param) const noexcept;
-    void smooth_lerp_bottom_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start, int plane_height, size_t stride, int border_size, int tr_s,
-        const int bits, const int lerp_plane_idx_param) const noexcept;
-
-    void smooth_gaussian_horizontal_impl(T_Pixel* AVS_RESTRICT row_ptr, int plane_width, int border_size, int tr_s, bool is_left_border,
-        T_Pixel* AVS_RESTRICT temp_buf, bool modify_original_pixels) const noexcept;
-    void smooth_gaussian_vertical_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start, int plane_height, size_t stride, int border_size,
-        int tr_s, bool is_top_border, T_Pixel* AVS_RESTRICT temp_buf, bool modify_original_pixels) const noexcept;
+    const bool m_borders_from_props;
+    // Number of frames that share one detected geometry, 0 when the borders are not detected.
+    const int m_autodetect_window;
+    // Largest average sample value of a border row/column, in the sample range of the clip.
+    const double m_autodetect_threshold;
+    // Components of a YUY2 or packed RGB clip, the components of packed RGB are stored as B, G, R(, A).
+    const std::optional<packed_layout> m_packed_layout;
+    // Fade targets of mode 5 and CPU level, shared by the core and the regions.
+    const std::optional<std::array<T_Calc, 4>> m_fade_target_value;
+    const int m_opt_level;
+    const core_t m_core;
+    std::shared_ptr<const geometry> m_geometry;
+    // [window] detected geometries of the windows seen last.
+    mutable std::mutex m_detected_windows_mutex;
+    mutable std::vector<std::pair<int, std::shared_ptr<const geometry>>> m_detected_windows;
+    // File the instrumentation is appended to when the instance is destroyed, empty when it is disabled.
+    const std::string m_stats_path;
+    const std::unique_ptr<fill_stats_histogram> m_stats;
+    // Rectangles filled after the outer borders, in the given order.
+    std::vector<std::unique_ptr<const fillborders_region<T_Pixel, T_Calc>>> m_regions;
+    // Clip whose non-zero samples are filled, null without mask.
+    const PClip m_mask;
+    // Masked runs of the mask frame seen last, reused while the mask frame stays the same.
+    mutable std::mutex m_mask_mutex;
+    mutable PVideoFrame m_mask_frame;
+    mutable std::shared_ptr<const mask_spans> m_mask_spans;
+    // Number of frames whose edges are filtered by mode 7, and whether their median or their average is used.
+    const int m_temporal_frames;
+    const bool m_temporal_median;
+    // [frame % m_temporal_frames] edges of the recent source frames, with their frame number. The edges are shared with the frames
+    // being filled, an entry is replaced rather than modified.
+    mutable std::mutex m_temporal_mutex;
+    mutable std::vector<std::pair<int, std::shared_ptr<const std::vector<T_Pixel>>>> m_temporal_edges;
+
+    auto cached_geometry(geometry&& g, IScriptEnvironment* env) const -> std::shared_ptr<const geometry>;
+    auto frame_geometry(const std::shared_ptr<const geometry>& base, const AVSMap* props, IScriptEnvironment* env) const
+        -> std::shared_ptr<const geometry>;
+    auto detected_geometry(int n, IScriptEnvironment* env) const -> std::shared_ptr<const geometry>;
+    auto frame_mask_spans(int n, IScriptEnvironment* env) const -> std::shared_ptr<const mask_spans>;
+    auto recent_edges(int n, const geometry& g, const frame_planes& current, IScriptEnvironment* env) const
+        -> std::vector<std::shared_ptr<const std::vector<T_Pixel>>>;
 
 public:
     FillBorders(PClip _child, AVSValue left, AVSValue top, AVSValue right, AVSValue bottom, int y, int u, int v, int a, bool interlaced,
-        int ts, int ts_mode, AVSValue fade_value, IScriptEnvironment* env);
+        AVSValue top2, AVSValue bottom2, int ts, int ts_mode, AVSValue fade_value, int opt, int threads, bool borders_from_props,
+        bool autodetect, float autodetect_thr, int autodetect_window, const char* stats, AVSValue regions, AVSValue mask,
+        int temporal_frames, bool temporal_median, IScriptEnvironment* env);
+    ~FillBorders() override;
 
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override;
 
-    int __stdcall SetCacheHints(int cachehints, int frame_range) noexcept override
+    int __stdcall SetCacheHints(int cachehints, [[maybe_unused]] int frame_range) noexcept override
     {
         return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
     }
@@ -107,22 +101,46 @@ std::array<int, 4> initialize_border_array(const AVSValue& border_avs_val, const
     for (int i{0}; i < num_values_from_script; ++i)
         result_array[i] = border_avs_val[i].AsInt();
 
-    if (num_values_from_script == 1)
-    {
-        const int chroma_value{result_array[0] >> subsample_shift};
-        result_array[1] = chroma_value;
-        result_array[2] = chroma_value;
-        result_array[3] = result_array[0];
-    }
-    else if (num_values_from_script == 2)
-    {
-        result_array[2] = result_array[1];
-        result_array[3] = result_array[0];
-    }
-    else if (num_values_from_script == 3)
-        result_array[3] = result_array[0];
+    return derive_border_array(result_array, num_values_from_script, subsample_shift);
+}
+
+std::array<std::array<int, 4>, 2> initialize_field_border_arrays(const AVSValue& border_avs_val, const AVSValue& field2_avs_val,
+    const VideoInfo& vi_ref, const int subsample_shift, IScriptEnvironment* env, const char* border_name_for_error,
+    const char* field2_name_for_error)
+{
+    const std::array<int, 4> first_field{initialize_border_array(border_avs_val, vi_ref, subsample_shift, env, border_name_for_error)};
+
+    if (!field2_avs_val.Defined())
+        return {first_field, first_field};
+
+    return {first_field, initialize_border_array(field2_avs_val, vi_ref, subsample_shift, env, field2_name_for_error)};
+}
+
+// Reads the sizes of one side from a frame property, returns false when the property is not set.
+bool read_border_prop(const AVSMap* props, const char* prop_name, const VideoInfo& vi_ref, const int subsample_shift,
+    IScriptEnvironment* env, std::array<int, 4>& border)
+{
+    const int num_values{env->propNumElements(props, prop_name)};
+
+    if (num_values <= 0)
+        return false;
+
+    if (num_values > vi_ref.NumComponents()) [[unlikely]]
+        env->ThrowError("FillBorders: more %s values given than there are planes", prop_name);
+
+    int error{};
+    const int64_t* values{env->propGetIntArray(props, prop_name, &error)};
+
+    if (error) [[unlikely]]
+        env->ThrowError("FillBorders: %s must be an integer or an array of integers.", prop_name);
 
-    return result_array;
+    std::array<int, 4> result_array{};
+
+    for (int i{0}; i < num_values; ++i)
+        result_array[i] = static_cast<int>(std::clamp<int64_t>(values[i], -1, std::numeric_limits<int>::max()));
+
+    border = derive_border_array(result_array, num_values, subsample_shift);
+    return true;
 }
 
 template<typename T_Calc>
@@ -190,8 +208,6 @@ std::optional<std::array<T_Calc, 4>> parse_and_scale_fade_targets(
 
     if (array_size == 1)
     {
-        T_Calc val_for_all{get_single_component_target_value(fade_value_from_script[0], 0)};
-
         for (int i{0}; i < num_components; ++i)
             targets[i] = get_single_component_target_value(fade_value_from_script[0], i);
     }
@@ -206,1304 +222,629 @@ std::optional<std::array<T_Calc, 4>> parse_and_scale_fade_targets(
     return std::optional<std::array<T_Calc, 4>>{targets};
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL>
-FillBorders<T_Pixel, T_Calc, MODE_VAL>::FillBorders(PClip _child, AVSValue left, AVSValue top, AVSValue right, AVSValue bottom, int y,
-    int u, int v, int a, bool interlaced, int ts, int ts_mode, AVSValue fade_value, IScriptEnvironment* env)
-    : GenericVideoFilter(_child),
-      m_subsample_shift_h((vi.IsY() || vi.IsRGB()) ? 0 : vi.GetPlaneHeightSubsampling(PLANAR_U)),
-      m_subsample_shift_w((vi.IsY() || vi.IsRGB()) ? 0 : vi.GetPlaneWidthSubsampling(PLANAR_U)),
-      m_left(initialize_border_array(left, vi, m_subsample_shift_w, env, "left")),
-      m_top(initialize_border_array(top, vi, m_subsample_shift_h, env, "top")),
-      m_right(initialize_border_array(right, vi, m_subsample_shift_w, env, "right")),
-      m_bottom(initialize_border_array(bottom, vi, m_subsample_shift_h, env, "bottom")),
-      m_interlaced(interlaced),
-      m_ts_runtime(ts),
-      m_ts_mode_runtime(ts_mode),
-      m_process([&] {
-          return (vi.IsRGB()) ? std::array<int, 4>{3, 3, 3, (vi.NumComponents() == 4) ? a : 1}
-                              : std::array<int, 4>{y, u, v, (vi.NumComponents() == 4) ? a : 1};
-      }()),
-      m_ts_kernel_data([&] {
-          std::array<float, TS_KERNELSIZE> kernel{};
-
-          if (ts > 0 && MODE_VAL == 4 && (ts_mode == 1 || ts_mode == 2))
-          {
-              const float p_gauss{1.2f};
-              float sum{};
-
-              for (int i{0}; i < TS_KERNELSIZE; ++i)
-              {
-                  const int val{i - TS_KERNELSIZE / 2};
-                  kernel[i] = static_cast<float>(std::pow(2.0, -p_gauss * val * val));
-                  sum += kernel[i];
-              }
-
-              if (sum != 0.0f)
-              {
-                  for (int i{0}; i < TS_KERNELSIZE; ++i)
-                      kernel[i] /= sum;
-              }
-              else if (TS_KERNELSIZE > 0)
-                  kernel[TS_KERNELSIZE / 2] = 1.0f;
-          }
-
-          return kernel;
-      }()),
-      m_fade_target_value(parse_and_scale_fade_targets<T_Calc>(fade_value, vi, env)),
-      has_at_least_v8(env->FunctionExists("propShow"))
+std::optional<packed_layout> get_packed_layout(const VideoInfo& vi_ref) noexcept
 {
-    if (!vi.IsPlanar())
-        env->ThrowError("FillBorders: only planar formats are supported.");
+    if (vi_ref.IsYUY2())
+        return packed_layout{{0, 1, 3, 0}, {2, 4, 4, 0}, 2};
 
-    if (y < 1 || y > 3)
-        env->ThrowError("FillBorders: y must be between 1..3.");
+    if (vi_ref.IsRGB24() || vi_ref.IsRGB48())
+        return packed_layout{{2, 1, 0, 0}, {3, 3, 3, 0}, 3};
 
-    if (u < 1 || u > 3)
-        env->ThrowError("FillBorders: u must be between 1..3.");
+    if (vi_ref.IsRGB32() || vi_ref.IsRGB64())
+        return packed_layout{{2, 1, 0, 3}, {4, 4, 4, 4}, 4};
 
-    if (v < 1 || v > 3)
-        env->ThrowError("FillBorders: v must be between 1..3.");
-
-    if (a < 1 || a > 3)
-        env->ThrowError("FillBorders: a must be between 1..3.");
-
-    if (m_ts_runtime < 0)
-        env->ThrowError("FillBorders: ts must be non-negative.");
+    return std::nullopt;
+}
 
-    if (m_ts_runtime * 2 > MAX_TSIZE && m_ts_runtime > 0)
-        env->ThrowError("FillBorders: ts*2 cannot exceed MAX_TSIZE (%d).", MAX_TSIZE);
+// AviSynth plane constants of the components, in the order of the planes of fillborders_format.
+const int* plane_order(const VideoInfo& vi_ref) noexcept
+{
+    static constexpr std::array<int, 4> yuv_plane_order{PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A};
+    static constexpr std::array<int, 4> rgb_plane_order{PLANAR_R, PLANAR_G, PLANAR_B, PLANAR_A};
 
-    if (m_ts_mode_runtime < 0 || m_ts_mode_runtime > 2)
-        env->ThrowError("FillBorders: ts_mode must be 0, 1, or 2.");
+    return (vi_ref.IsRGB()) ? rgb_plane_order.data() : yuv_plane_order.data();
+}
 
-    const int chr_w{vi.width >> m_subsample_shift_w};
-    const int chr_h{vi.height >> m_subsample_shift_h};
-    const std::array<int, 4> plane_widths_map{vi.width, chr_w, chr_w, vi.width};
-    const std::array<int, 4> plane_heights_map{vi.height, chr_h, chr_h, vi.height};
+// regions: one array [x, y, width, height, mode, left, top, right, bottom] per rectangle. A size is an integer or an array with a value per
+// plane, like the parameters left, top, right, bottom.
+std::vector<fill_region_params> parse_regions(
+    const AVSValue& regions, const VideoInfo& vi_ref, const int subsample_shift_w, const int subsample_shift_h, IScriptEnvironment* env)
+{
+    std::vector<fill_region_params> result;
 
-    for (int i{}; i < vi.NumComponents(); ++i)
+    for (int i{0}; i < regions.ArraySize(); ++i)
     {
-        if (m_process[i] == 3)
-        {
-            if (m_left[i] < 0)
-                env->ThrowError("FillBorders: left must be equal to or greater than 0.");
-
-            if (m_top[i] < 0)
-                env->ThrowError("FillBorders: top must be equal to or greater than 0.");
+        const AVSValue& region{regions[i]};
 
-            if (m_right[i] < 0)
-                env->ThrowError("FillBorders: right must be equal to or greater than 0.");
+        if (!region.IsArray() || region.ArraySize() != 9)
+            env->ThrowError("FillBorders: each region must be an array [x, y, width, height, mode, left, top, right, bottom].");
 
-            if (m_bottom[i] < 0)
-                env->ThrowError("FillBorders: bottom must be equal to or greater than 0.");
+        for (int k{0}; k < 5; ++k)
+        {
+            if (!region[k].IsInt())
+                env->ThrowError("FillBorders: x, y, width, height and mode of a region must be integers.");
+        }
 
-            if (m_ts_runtime > 0 && MODE_VAL == 4)
-            {
-                if (m_left[i] > 0 && m_ts_runtime > m_left[i])
-                    env->ThrowError("FillBorders: ts must be <= left border size for component %d.", i);
+        result.push_back({region[0].AsInt(), region[1].AsInt(), region[2].AsInt(), region[3].AsInt(), region[4].AsInt(),
+            initialize_border_array(region[5], vi_ref, subsample_shift_w, env, "region left"),
+            initialize_border_array(region[6], vi_ref, subsample_shift_h, env, "region top"),
+            initialize_border_array(region[7], vi_ref, subsample_shift_w, env, "region right"),
+            initialize_border_array(region[8], vi_ref, subsample_shift_h, env, "region bottom")});
+    }
 
-                if (m_top[i] > 0 && m_ts_runtime > m_top[i])
-                    env->ThrowError("FillBorders: ts must be <= top border size for component %d.", i);
+    return result;
+}
 
-                if (m_right[i] > 0 && m_ts_runtime > m_right[i])
-                    env->ThrowError("FillBorders: ts must be <= right border size for component %d.", i);
+int get_opt_level(const int opt, IScriptEnvironment* env)
+{
+    if (opt < -1 || opt > OPT_AVX512)
+        env->ThrowError("FillBorders: opt must be between -1..3.");
 
-                if (m_bottom[i] > 0 && m_ts_runtime > m_bottom[i])
-                    env->ThrowError("FillBorders: ts must be <= bottom border size for component %d.", i);
-            }
+    const int cpu_flags{env->GetCPUFlags()};
+    const bool has_sse41{!!(cpu_flags & CPUF_SSE4_1)};
+    const bool has_avx2{!!(cpu_flags & CPUF_AVX2)};
+    const bool has_avx512{(cpu_flags & CPUF_AVX512F) && (cpu_flags & CPUF_AVX512BW)};
 
-            const int current_plane_w_check{plane_widths_map[i]};
-            const int current_plane_h_check{plane_heights_map[i]};
+    if (opt == -1)
+        return (has_avx512) ? OPT_AVX512 : (has_avx2) ? OPT_AVX2 : (has_sse41) ? OPT_SSE41 : OPT_C;
 
-            if (MODE_VAL == 0 || MODE_VAL == 1 || MODE_VAL == 5 || MODE_VAL == 6)
-            {
-                if (current_plane_w_check < m_left[i] + m_right[i] || current_plane_h_check < m_top[i] + m_bottom[i])
-                    env->ThrowError("FillBorders: borders are too big for component %d (mode %d).", i, MODE_VAL);
-            }
-            else if (MODE_VAL == 2 || MODE_VAL == 3)
-            {
-                if (m_left[i] > 0 && current_plane_w_check < 2 * m_left[i])
-                    env->ThrowError("FillBorders: clip too small for left border on component %d, mode %d", i, MODE_VAL);
+    if (opt == OPT_SSE41 && !has_sse41)
+        env->ThrowError("FillBorders: opt=1 requires SSE4.1.");
 
-                if (m_right[i] > 0 && current_plane_w_check < 2 * m_right[i])
-                    env->ThrowError("FillBorders: clip too small for right border on component %d, mode %d", i, MODE_VAL);
+    if (opt == OPT_AVX2 && !has_avx2)
+        env->ThrowError("FillBorders: opt=2 requires AVX2.");
 
-                if (m_top[i] > 0 && current_plane_h_check < 2 * m_top[i])
-                    env->ThrowError("FillBorders: clip too small for top border on component %d, mode %d", i, MODE_VAL);
+    if (opt == OPT_AVX512 && !has_avx512)
+        env->ThrowError("FillBorders: opt=3 requires AVX512F and AVX512BW.");
 
-                if (m_bottom[i] > 0 && current_plane_h_check < 2 * m_bottom[i])
-                    env->ThrowError("FillBorders: clip too small for bottom border on component %d, mode %d", i, MODE_VAL);
-            }
-            else if (MODE_VAL == 4)
-            {
-                if (current_plane_w_check < m_left[i] + m_right[i] || current_plane_h_check < m_top[i] + m_bottom[i])
-                    env->ThrowError("FillBorders: borders too big for wrap mode on component %d", i);
-            }
-        }
-    }
+    return opt;
 }
 
 template<typename T_Pixel, typename T_Calc, int MODE_VAL>
-PVideoFrame __stdcall FillBorders<T_Pixel, T_Calc, MODE_VAL>::GetFrame(int n, IScriptEnvironment* env)
+FillBorders<T_Pixel, T_Calc, MODE_VAL>::FillBorders(PClip _child, AVSValue left, AVSValue top, AVSValue right, AVSValue bottom, int y,
+    int u, int v, int a, bool interlaced, AVSValue top2, AVSValue bottom2, int ts, int ts_mode, AVSValue fade_value, int opt,
+    int threads, bool borders_from_props, bool autodetect, float autodetect_thr, int autodetect_window, const char* stats,
+    AVSValue regions, AVSValue mask, int temporal_frames, bool temporal_median, IScriptEnvironment* env)
+    : GenericVideoFilter(_child),
+      m_subsample_shift_h((vi.IsY() || vi.IsRGB() || vi.IsYUY2()) ? 0 : vi.GetPlaneHeightSubsampling(PLANAR_U)),
+      m_subsample_shift_w((vi.IsYUY2()) ? 1 : ((vi.IsY() || vi.IsRGB()) ? 0 : vi.GetPlaneWidthSubsampling(PLANAR_U))),
+      m_interlaced(interlaced),
+      m_ts_runtime(ts),
+      has_at_least_v8(env->FunctionExists("propShow")),
+      m_borders_from_props(borders_from_props),
+      m_autodetect_window((autodetect) ? autodetect_window : 0),
+      m_autodetect_threshold(
+          (vi.BitsPerComponent() == 32) ? autodetect_thr / 255.0 : autodetect_thr * (1 << (vi.BitsPerComponent() - 8))),
+      m_packed_layout(get_packed_layout(vi)),
+      m_fade_target_value(parse_and_scale_fade_targets<T_Calc>(fade_value, vi, env)),
+      m_opt_level(get_opt_level(opt, env)),
+      m_core({vi.width, vi.height, vi.NumComponents(), vi.BitsPerComponent(), m_subsample_shift_w, m_subsample_shift_h, vi.IsRGB()},
+          (vi.IsRGB()) ? std::array<int, 4>{3, 3, 3, (vi.NumComponents() == 4) ? a : 1}
+                       : std::array<int, 4>{y, u, v, (vi.NumComponents() == 4) ? a : 1},
+          interlaced, ts, ts_mode, m_fade_target_value, m_opt_level, threads),
+      m_stats_path((stats) ? stats : ""),
+      m_stats((m_stats_path.empty()) ? nullptr : std::make_unique<fill_stats_histogram>()),
+      m_mask((mask.Defined()) ? mask.AsClip() : nullptr),
+      m_temporal_frames(temporal_frames),
+      m_temporal_median(temporal_median)
 {
-    PVideoFrame src_frame{child->GetFrame(n, env)};
-
-    if (!m_interlaced) [[likely]]
-    {
-        if (has_at_least_v8) [[likely]]
-        {
-            const AVSMap* props{env->getFramePropsRO(src_frame)};
-
-            if (env->propNumElements(props, "_FieldBased") > 0)
-            {
-                const int64_t field_based{env->propGetInt(props, "_FieldBased", 0, nullptr)};
+    if (!vi.IsPlanar() && !m_packed_layout)
+        env->ThrowError("FillBorders: only planar, YUY2 and packed RGB formats are supported.");
 
-                if (field_based > 0) [[unlikely]]
-                    env->ThrowError("FillBorders: frame must be not interlaced or use interlaced=true.");
-            }
-        }
-    }
+    if (y < 1 || y > 3)
+        env->ThrowError("FillBorders: y must be between 1..3.");
 
-    PVideoFrame dst_frame{(has_at_least_v8) ? env->NewVideoFrameP(vi, &src_frame) : env->NewVideoFrame(vi)};
+    if (u < 1 || u > 3)
+        env->ThrowError("FillBorders: u must be between 1..3.");
 
-    constexpr std::array<int, 4> yuv_plane_order{PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A};
-    constexpr std::array<int, 4> rgb_plane_order{PLANAR_R, PLANAR_G, PLANAR_B, PLANAR_A};
-    const int* const plane_constants{vi.IsRGB() ? rgb_plane_order.data() : yuv_plane_order.data()};
+    if (v < 1 || v > 3)
+        env->ThrowError("FillBorders: v must be between 1..3.");
 
-    T_Pixel temp_buf_for_gaussian[MAX_TSIZE];
+    if (a < 1 || a > 3)
+        env->ThrowError("FillBorders: a must be between 1..3.");
 
-    for (int i{0}; i < vi.NumComponents(); ++i)
-    {
-        const int current_plane{plane_constants[i]};
+    if (m_borders_from_props && !has_at_least_v8)
+        env->ThrowError("FillBorders: borders_from_props requires AviSynth+ 3.7.0 or later.");
 
-        if (m_process[i] == 1) [[unlikely]]
-            continue;
+    if (autodetect && autodetect_window < 1)
+        env->ThrowError("FillBorders: autodetect_window must be greater than 0.");
 
-        const int height{src_frame->GetHeight(current_plane)};
-        const int width{src_frame->GetRowSize(current_plane)};
-        const int src_stride{src_frame->GetPitch(current_plane)};
-        const int dst_stride{dst_frame->GetPitch(current_plane)};
-        const uint8_t* AVS_RESTRICT const srcp{src_frame->GetReadPtr(current_plane)};
-        uint8_t* const dstp{dst_frame->GetWritePtr(current_plane)};
+    if (m_interlaced && vi.IsFieldBased())
+        env->ThrowError("FillBorders: interlaced=true requires a frame-based clip.");
 
-        env->BitBlt(dstp, dst_stride, srcp, src_stride, width, height);
+    if (m_packed_layout && autodetect)
+        env->ThrowError("FillBorders: autodetect is not supported for packed formats.");
 
-        if (m_process[i] == 2) [[unlikely]]
-            continue;
+    if constexpr (MODE_VAL == 7)
+    {
+        if (m_temporal_frames < 1 || m_temporal_frames > MAX_TEMPORAL_FRAMES)
+            env->ThrowError("FillBorders: temporal_frames must be between 1..%d.", MAX_TEMPORAL_FRAMES);
 
-        const int width_processing{static_cast<int>(width / sizeof(T_Pixel))};
-        const int stride_processing{static_cast<int>(dst_stride / sizeof(T_Pixel))};
-        T_Pixel* AVS_RESTRICT const dstp_processing{reinterpret_cast<T_Pixel*>(dstp)};
+        if (m_packed_layout)
+            env->ThrowError("FillBorders: mode 7 is not supported for packed formats.");
 
-        const int image_bits{vi.BitsPerComponent()};
-        const int lerp_float_plane_category{[&]() {
-            if (!vi.IsRGB())
-            {
-                if (current_plane == PLANAR_U)
-                    return 1;
-                else if (current_plane == PLANAR_V)
-                    return 2;
-                else
-                    return 0;
-            }
-            else
-                return 0;
-        }()};
-
-        if constexpr (MODE_VAL == 0)
-            handle_mode_0_fillmargins_impl(dstp_processing, width_processing, height, stride_processing, i);
-        else if constexpr (MODE_VAL == 1)
-            handle_mode_1_repeat_impl(dstp_processing, width_processing, height, stride_processing, i);
-        else if constexpr (MODE_VAL == 2)
-            handle_mode_2_mirror_impl(dstp_processing, width_processing, height, stride_processing, i);
-        else if constexpr (MODE_VAL == 3)
-            handle_mode_3_reflect_impl(dstp_processing, width_processing, height, stride_processing, i);
-        else if constexpr (MODE_VAL == 4)
-        {
-            handle_mode_4_wrap_base_impl(dstp_processing, width_processing, height, stride_processing, i);
+        if (m_borders_from_props || autodetect)
+            env->ThrowError("FillBorders: mode 7 requires fixed borders (borders_from_props and autodetect are not supported).");
 
-            if (m_ts_runtime > 0) [[likely]]
-                apply_mode4_transient_smoothing_impl(dstp_processing, width_processing, height, stride_processing, i, image_bits,
-                    lerp_float_plane_category, temp_buf_for_gaussian);
-        }
-        else if constexpr (MODE_VAL == 5)
-            handle_mode_5_fade_impl(dstp_processing, width_processing, height, stride_processing, i, image_bits, lerp_float_plane_category);
-        else if constexpr (MODE_VAL == 6)
-            handle_mode_6_fixborders_impl(dstp_processing, width_processing, height, stride_processing, i);
+        m_temporal_edges.assign(m_temporal_frames, {-1, nullptr});
     }
 
-    return dst_frame;
-}
-
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_0_fillmargins_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
-{
-    for (int y{m_top[component_idx]}; y < plane_height - m_bottom[component_idx]; ++y)
+    if (m_mask)
     {
-        T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
+        const VideoInfo& mask_vi{m_mask->GetVideoInfo()};
 
-        if (m_left[component_idx] > 0)
-        {
-            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
-                std::memset(current_row_ptr, current_row_ptr[m_left[component_idx]], m_left[component_idx]);
-            else
-                memset16<T_Pixel>(current_row_ptr, current_row_ptr[m_left[component_idx]], m_left[component_idx]);
-        }
+        if (m_packed_layout)
+            env->ThrowError("FillBorders: mask is not supported for packed formats.");
 
-        if (m_right[component_idx] > 0)
-        {
-            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
-                std::memset(current_row_ptr + plane_width - m_right[component_idx],
-                    current_row_ptr[plane_width - m_right[component_idx] - 1], m_right[component_idx]);
-            else
-                memset16<T_Pixel>(current_row_ptr + plane_width - m_right[component_idx],
-                    current_row_ptr[plane_width - m_right[component_idx] - 1], m_right[component_idx]);
-        }
-    }
+        if (!mask_vi.IsPlanar() || mask_vi.width != vi.width || mask_vi.height != vi.height)
+            env->ThrowError("FillBorders: mask must be a planar clip with the dimensions of the clip.");
 
-    for (int y{m_top[component_idx] - 1}; y >= 0; --y)
-    {
-        if (y + 1 >= plane_height) [[unlikely]]
-            continue;
+        // A greyscale mask is used for all planes, otherwise plane i of the mask is the mask of plane i.
+        const bool same_planes{mask_vi.NumComponents() >= vi.NumComponents() && mask_vi.IsRGB() == vi.IsRGB() &&
+                               (vi.IsY() || vi.IsRGB() ||
+                                   (mask_vi.GetPlaneWidthSubsampling(PLANAR_U) == m_subsample_shift_w &&
+                                       mask_vi.GetPlaneHeightSubsampling(PLANAR_U) == m_subsample_shift_h))};
 
-        const T_Pixel* AVS_RESTRICT const prev_row{dstp + stride * static_cast<int64_t>(y + 1)};
-        T_Pixel* AVS_RESTRICT const curr_row{dstp + stride * static_cast<int64_t>(y)};
+        if (!mask_vi.IsY() && !same_planes)
+            env->ThrowError("FillBorders: mask must be greyscale or have the planes of the clip.");
+    }
 
-        if (plane_width > 0)
-            curr_row[0] = prev_row[0];
+    std::string error{m_core.check()};
 
-        if (plane_width > 1)
-        {
-            const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+    if (error.empty() && m_packed_layout)
+        error = m_core.check_packed();
 
-            if (num_edge_pixels_to_copy > 0)
-                std::memcpy(curr_row + plane_width - num_edge_pixels_to_copy, prev_row + plane_width - num_edge_pixels_to_copy,
-                    static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
-        }
+    if (error.empty() && m_mask)
+        error = m_core.check_mask();
 
-        for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-        {
-            if (x - 1 < 0 || x + 1 >= plane_width) [[unlikely]]
-                continue;
+    if (!error.empty())
+        env->ThrowError("%s", error.c_str());
 
-            const T_Calc p{static_cast<T_Calc>(prev_row[x - 1])};
-            const T_Calc c{static_cast<T_Calc>(prev_row[x])};
-            const T_Calc n{static_cast<T_Calc>(prev_row[x + 1])};
+    geometry g{initialize_border_array(left, vi, m_subsample_shift_w, env, "left"),
+        initialize_field_border_arrays(top, top2, vi, m_subsample_shift_h, env, "top", "top2"),
+        initialize_border_array(right, vi, m_subsample_shift_w, env, "right"),
+        initialize_field_border_arrays(bottom, bottom2, vi, m_subsample_shift_h, env, "bottom", "bottom2")};
 
-            if constexpr (std::is_integral_v<T_Pixel>)
-                curr_row[x] = static_cast<T_Pixel>((3 * p + 2 * c + 3 * n) / 8);
-            else
-                curr_row[x] = static_cast<T_Pixel>((3 * p + 2 * c + 3 * n) / 8.0f);
-        }
-    }
+    if (!m_interlaced && (g.top[0] != g.top[1] || g.bottom[0] != g.bottom[1]))
+        env->ThrowError("FillBorders: top2 and bottom2 require interlaced=true.");
 
-    for (int y{plane_height - m_bottom[component_idx]}; y < plane_height; ++y)
-    {
-        if (y - 1 < 0) [[unlikely]]
-            continue;
+    m_geometry = m_core.get_geometry(std::move(g), error);
 
-        const T_Pixel* AVS_RESTRICT const prev_row{dstp + stride * static_cast<int64_t>(y - 1)};
-        T_Pixel* AVS_RESTRICT const curr_row{dstp + stride * static_cast<int64_t>(y)};
+    if (!m_geometry)
+        env->ThrowError("%s", error.c_str());
 
-        if (plane_width > 0)
-            curr_row[0] = prev_row[0];
+    if (!regions.Defined() || !regions.ArraySize())
+        return;
 
-        if (plane_width > 1)
-        {
-            const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+    if (m_packed_layout)
+        env->ThrowError("FillBorders: regions are not supported for packed formats.");
 
-            if (num_edge_pixels_to_copy > 0)
-                std::memcpy(curr_row + plane_width - num_edge_pixels_to_copy, prev_row + plane_width - num_edge_pixels_to_copy,
-                    static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
-        }
+    const fillborders_format format{
+        vi.width, vi.height, vi.NumComponents(), vi.BitsPerComponent(), m_subsample_shift_w, m_subsample_shift_h, vi.IsRGB()};
+    // The rectangles are filled in place, only in the planes whose borders are filled.
+    std::array<int, 4> region_process{(vi.IsRGB()) ? 3 : y, (vi.IsRGB()) ? 3 : u, (vi.IsRGB()) ? 3 : v, a};
 
-        for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-        {
-            if (x - 1 < 0 || x + 1 >= plane_width) [[unlikely]]
-                continue;
+    for (int& process : region_process)
+        process = (process == 3) ? 3 : 1;
 
-            const T_Calc p{static_cast<T_Calc>(prev_row[x - 1])};
-            const T_Calc c{static_cast<T_Calc>(prev_row[x])};
-            const T_Calc n{static_cast<T_Calc>(prev_row[x + 1])};
+    for (const fill_region_params& region : parse_regions(regions, vi, m_subsample_shift_w, m_subsample_shift_h, env))
+    {
+        m_regions.emplace_back(fillborders_region<T_Pixel, T_Calc>::create(
+            format, region, region_process, interlaced, ts, ts_mode, m_fade_target_value, m_opt_level, threads, error));
 
-            if constexpr (std::is_integral_v<T_Pixel>)
-                curr_row[x] = static_cast<T_Pixel>((3 * p + 2 * c + 3 * n) / 8);
-            else
-                curr_row[x] = static_cast<T_Pixel>((3 * p + 2 * c + 3 * n) / 8.0f);
-        }
+        if (!m_regions.back())
+            env->ThrowError("%s", error.c_str());
     }
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_1_repeat_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+FillBorders<T_Pixel, T_Calc, MODE_VAL>::~FillBorders()
 {
-    for (int y{m_top[component_idx]}; y < plane_height - m_bottom[component_idx]; ++y)
-    {
-        T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
-
-        if (m_left[component_idx] > 0)
-        {
-            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
-                std::memset(current_row_ptr, current_row_ptr[m_left[component_idx]], m_left[component_idx]);
-            else
-                memset16<T_Pixel>(current_row_ptr, current_row_ptr[m_left[component_idx]], m_left[component_idx]);
-        }
-
-        if (m_right[component_idx] > 0)
-        {
-            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
-                std::memset(current_row_ptr + plane_width - m_right[component_idx],
-                    current_row_ptr[plane_width - m_right[component_idx] - 1], m_right[component_idx]);
-            else
-                memset16<T_Pixel>(current_row_ptr + plane_width - m_right[component_idx],
-                    current_row_ptr[plane_width - m_right[component_idx] - 1], m_right[component_idx]);
-        }
-    }
+    if (!m_stats)
+        return;
 
-    if (m_top[component_idx] > 0)
+    if (std::FILE* file{std::fopen(m_stats_path.c_str(), "a")})
     {
-        const int src_y_top{m_top[component_idx]};
-
-        if (src_y_top < plane_height && plane_width > 0) [[likely]]
-        {
-            const T_Pixel* AVS_RESTRICT const src_row_ptr{dstp + static_cast<int64_t>(stride) * src_y_top};
-
-            for (int y{0}; y < m_top[component_idx]; ++y)
-                std::memcpy(dstp + static_cast<int64_t>(stride) * y, src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
-    }
-    if (m_bottom[component_idx] > 0)
-    {
-        const int src_y_bottom{plane_height - m_bottom[component_idx] - 1};
-        if (src_y_bottom >= 0 && plane_width > 0) [[likely]]
-        {
-            const T_Pixel* AVS_RESTRICT const src_row_ptr{dstp + static_cast<int64_t>(stride) * src_y_bottom};
-
-            for (int y{plane_height - m_bottom[component_idx]}; y < plane_height; ++y)
-                std::memcpy(dstp + static_cast<int64_t>(stride) * y, src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
+        std::fputs((m_stats->to_json("FillBorders", vi.NumComponents()) + "\n").c_str(), file);
+        std::fclose(file);
     }
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_2_mirror_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto FillBorders<T_Pixel, T_Calc, MODE_VAL>::cached_geometry(geometry&& g, IScriptEnvironment* env) const
+    -> std::shared_ptr<const geometry>
 {
-    for (int y{m_top[component_idx]}; y < plane_height - m_bottom[component_idx]; ++y)
-    {
-        T_Pixel* AVS_RESTRICT const row_ptr{dstp + stride * static_cast<int64_t>(y)};
+    if (g.left == m_geometry->left && g.top == m_geometry->top && g.right == m_geometry->right && g.bottom == m_geometry->bottom)
+        [[likely]]
+        return m_geometry;
 
-        for (int x{0}; x < m_left[component_idx]; ++x)
-        {
-            const int src_x{m_left[component_idx] * 2 - 1 - x};
+    std::string error;
+    std::shared_ptr<const geometry> cached{m_core.get_geometry(std::move(g), error)};
 
-            if (src_x >= 0 && src_x < plane_width) [[likely]]
-                row_ptr[x] = row_ptr[src_x];
-        }
-
-        for (int x{0}; x < m_right[component_idx]; ++x)
-        {
-            const int src_x{plane_width - m_right[component_idx] - 1 - x};
-
-            if (src_x >= 0 && src_x < plane_width) [[likely]]
-                row_ptr[plane_width - m_right[component_idx] + x] = row_ptr[src_x];
-        }
-    }
-
-    if (m_top[component_idx] > 0 && plane_width > 0)
-    {
-        for (int y{0}; y < m_top[component_idx]; ++y)
-        {
-            const int64_t src_y{m_top[component_idx] * 2LL - 1 - y};
-
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-                std::memcpy(
-                    dstp + static_cast<int64_t>(stride) * y, dstp + stride * src_y, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
-    }
-
-    if (m_bottom[component_idx] > 0 && plane_width > 0)
-    {
-        for (int y_offset{0}; y_offset < m_bottom[component_idx]; ++y_offset)
-        {
-            const int y_to_fill{plane_height - m_bottom[component_idx] + y_offset};
-            const int64_t src_y{static_cast<int64_t>(plane_height) - m_bottom[component_idx] - 1 - y_offset};
+    if (!cached) [[unlikely]]
+        env->ThrowError("%s", error.c_str());
 
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-                std::memcpy(dstp + stride * static_cast<int64_t>(y_to_fill), dstp + stride * src_y,
-                    static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
-    }
+    return cached;
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_3_reflect_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto FillBorders<T_Pixel, T_Calc, MODE_VAL>::frame_geometry(const std::shared_ptr<const geometry>& base, const AVSMap* props,
+    IScriptEnvironment* env) const -> std::shared_ptr<const geometry>
 {
-    for (int y{m_top[component_idx]}; y < plane_height - m_bottom[component_idx]; ++y)
-    {
-        T_Pixel* AVS_RESTRICT const row_ptr{dstp + stride * static_cast<int64_t>(y)};
+    // A side without property keeps the sizes of the filter parameters (or the detected ones).
+    geometry g{base->left, base->top, base->right, base->bottom};
 
-        for (int x{0}; x < m_left[component_idx]; ++x)
-        {
-            const int src_x{m_left[component_idx] * 2 - x};
+    read_border_prop(props, "_FillBorders_Left", vi, m_subsample_shift_w, env, g.left);
+    read_border_prop(props, "_FillBorders_Right", vi, m_subsample_shift_w, env, g.right);
 
-            if (src_x >= 0 && src_x < plane_width) [[likely]]
-                row_ptr[x] = row_ptr[src_x];
-        }
+    if (read_border_prop(props, "_FillBorders_Top", vi, m_subsample_shift_h, env, g.top[0]))
+        g.top[1] = g.top[0];
 
-        for (int x{0}; x < m_right[component_idx]; ++x)
-        {
-            const int src_x{plane_width - m_right[component_idx] - 2 - x};
+    if (read_border_prop(props, "_FillBorders_Bottom", vi, m_subsample_shift_h, env, g.bottom[0]))
+        g.bottom[1] = g.bottom[0];
 
-            if (src_x >= 0 && src_x < plane_width) [[likely]]
-                row_ptr[plane_width - m_right[component_idx] + x] = row_ptr[src_x];
-        }
-    }
-
-    if (m_top[component_idx] > 0 && plane_width > 0)
+    if (m_interlaced)
     {
-        for (int y{0}; y < m_top[component_idx]; ++y)
-        {
-            const int64_t src_y{m_top[component_idx] * 2LL - y};
-
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-                std::memcpy(
-                    dstp + static_cast<int64_t>(stride) * y, dstp + stride * src_y, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
+        read_border_prop(props, "_FillBorders_Top2", vi, m_subsample_shift_h, env, g.top[1]);
+        read_border_prop(props, "_FillBorders_Bottom2", vi, m_subsample_shift_h, env, g.bottom[1]);
     }
 
-    if (m_bottom[component_idx] > 0 && plane_width > 0)
-    {
-        for (int y_offset{0}; y_offset < m_bottom[component_idx]; ++y_offset)
-        {
-            const int y_to_fill{plane_height - m_bottom[component_idx] + y_offset};
-            const int64_t src_y{static_cast<int64_t>(plane_height) - m_bottom[component_idx] - 2 - y_offset};
+    if (g.left == base->left && g.top == base->top && g.right == base->right && g.bottom == base->bottom) [[likely]]
+        return base;
 
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-                std::memcpy(dstp + stride * static_cast<int64_t>(y_to_fill), dstp + stride * src_y,
-                    static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-        }
-    }
+    return cached_geometry(std::move(g), env);
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_4_wrap_base_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto FillBorders<T_Pixel, T_Calc, MODE_VAL>::detected_geometry(const int n, IScriptEnvironment* env) const
+    -> std::shared_ptr<const geometry>
 {
-    for (int y{m_top[component_idx]}; y < plane_height - m_bottom[component_idx]; ++y)
-    {
-        T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
-
-        if (m_left[component_idx] > 0)
-        {
-            for (int x{0}; x < m_left[component_idx]; ++x)
-            {
-                const int src_x{plane_width - m_right[component_idx] - m_left[component_idx] + x};
+    const int window{n / m_autodetect_window};
 
-                if (src_x >= 0 && src_x < plane_width) [[likely]]
-                    current_row_ptr[x] = current_row_ptr[src_x];
-                else if (plane_width > 0)
-                    current_row_ptr[x] = current_row_ptr[0];
-            }
-        }
-        if (m_right[component_idx] > 0)
-        {
-            for (int x{0}; x < m_right[component_idx]; ++x)
-            {
-                const int src_x{m_left[component_idx] + x};
-
-                if (src_x >= 0 && src_x < plane_width) [[likely]]
-                    current_row_ptr[plane_width - m_right[component_idx] + x] = current_row_ptr[src_x];
-                else if (plane_width > 0)
-                    current_row_ptr[plane_width - m_right[component_idx] + x] = current_row_ptr[plane_width - 1];
-            }
-        }
-    }
-
-    if (m_top[component_idx] > 0 && plane_width > 0) [[likely]]
     {
-        for (int y_fill{0}; y_fill < m_top[component_idx]; ++y_fill)
-        {
-            const int64_t src_y{static_cast<int64_t>(plane_height) - m_bottom[component_idx] - m_top[component_idx] + y_fill};
-            T_Pixel* AVS_RESTRICT const dst_row_ptr{dstp + static_cast<int64_t>(y_fill) * stride};
-
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-            {
-                const T_Pixel* AVS_RESTRICT const src_row_ptr{dstp + src_y * stride};
-                std::memcpy(dst_row_ptr, src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-            }
-            else if (plane_height > 0) [[unlikely]]
-            {
-                const T_Pixel* AVS_RESTRICT const fallback_src_row_ptr{dstp}; // Row 0
-                std::memcpy(dst_row_ptr, fallback_src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-            }
-        }
-    }
+        std::lock_guard<std::mutex> lock{m_detected_windows_mutex};
 
-    if (m_bottom[component_idx] > 0 && plane_width > 0) [[likely]]
-    {
-        for (int y_offset_in_bottom_border{0}; y_offset_in_bottom_border < m_bottom[component_idx]; ++y_offset_in_bottom_border)
+        for (const auto& [detected_window, detected] : m_detected_windows)
         {
-            const int y_fill{plane_height - m_bottom[component_idx] + y_offset_in_bottom_border};
-            const int64_t src_y{static_cast<int64_t>(m_top[component_idx]) + y_offset_in_bottom_border};
-            T_Pixel* AVS_RESTRICT const dst_row_ptr{dstp + static_cast<int64_t>(y_fill) * stride};
-
-            if (src_y >= 0 && src_y < plane_height) [[likely]]
-            {
-                const T_Pixel* AVS_RESTRICT const src_row_ptr{dstp + src_y * stride};
-                std::memcpy(dst_row_ptr, src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-            }
-            else if (plane_height > 0) [[unlikely]]
-            {
-                const T_Pixel* AVS_RESTRICT const fallback_src_row_ptr{dstp + static_cast<int64_t>(plane_height - 1) * stride};
-                std::memcpy(dst_row_ptr, fallback_src_row_ptr, static_cast<size_t>(plane_width) * sizeof(T_Pixel));
-            }
+            if (detected_window == window)
+                return detected;
         }
     }
-}
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::apply_mode4_transient_smoothing_impl(T_Pixel* AVS_RESTRICT dstp, const int plane_width,
-    const int plane_height, const size_t stride, const int component_idx, const int bits, const int lerp_plane_idx_param,
-    T_Pixel* AVS_RESTRICT temp_buf) const noexcept
-{
-    const int tr_s{std::min(m_ts_runtime, MAX_TSIZE / 2)};
+    const int first_frame{window * m_autodetect_window};
+    const int last_frame{std::min(first_frame + m_autodetect_window, vi.num_frames) - 1};
+    const int plane{(vi.IsRGB()) ? PLANAR_R : PLANAR_Y};
+    // The first, middle and last frames of the window are measured. The smallest border of each side is used, so a dark frame does
+    // not widen the borders.
+    std::array<int, 4> borders{std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+        std::numeric_limits<int>::max()};
 
-    if (tr_s == 0) [[unlikely]]
-        return;
-
-    if (m_left[component_idx] > 0 && tr_s <= m_left[component_idx]) [[likely]]
+    for (const int frame_n : {first_frame, (first_frame + last_frame) / 2, last_frame})
     {
-        for (int y{0}; y < plane_height; ++y)
-        {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
+        const PVideoFrame frame{child->GetFrame(frame_n, env)};
+        const std::array<int, 4> frame_borders{detect_plane_borders(reinterpret_cast<const T_Pixel*>(frame->GetReadPtr(plane)),
+            static_cast<int>(frame->GetRowSize(plane) / sizeof(T_Pixel)), frame->GetHeight(plane),
+            frame->GetPitch(plane) / static_cast<int>(sizeof(T_Pixel)), m_autodetect_threshold)};
 
-            switch (m_ts_mode_runtime)
-            {
-            case 0: // Lerp Gradient
-                smooth_lerp_left_impl(current_row_ptr, plane_width, m_left[component_idx], tr_s, bits, lerp_plane_idx_param);
-                break;
-            case 1: // Gaussian Blur - No Original Pixel Change
-                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, m_left[component_idx], tr_s, true, temp_buf, false);
-                break;
-            case 2: // Gaussian Blur - Original Pixels Changed
-                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, m_left[component_idx], tr_s, true, temp_buf, true);
-                break;
-            }
-        }
+        for (int side{0}; side < 4; ++side)
+            borders[side] = std::min(borders[side], frame_borders[side]);
+
+        if (first_frame == last_frame)
+            break;
     }
 
-    if (m_right[component_idx] > 0 && tr_s <= m_right[component_idx]) [[likely]]
-    {
-        for (int y{0}; y < plane_height; ++y)
-        {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
+    // The subsampled planes are rounded up, so no partly dark column or row is left.
+    const auto derive_detected{[](const int value, const int subsample_shift) noexcept -> std::array<int, 4> {
+        const int chroma_value{(value + (1 << subsample_shift) - 1) >> subsample_shift};
+        return {value, chroma_value, chroma_value, value};
+    }};
 
-            switch (m_ts_mode_runtime)
-            {
-            case 0:
-                smooth_lerp_right_impl(current_row_ptr, plane_width, m_right[component_idx], tr_s, bits, lerp_plane_idx_param);
-                break;
-            case 1:
-                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, m_right[component_idx], tr_s, false, temp_buf, false);
-                break;
-            case 2:
-                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, m_right[component_idx], tr_s, false, temp_buf, true);
-                break;
-            }
-        }
-    }
+    geometry g{derive_detected(borders[SIDE_LEFT], m_subsample_shift_w), {}, derive_detected(borders[SIDE_RIGHT], m_subsample_shift_w)};
 
-    if (m_top[component_idx] > 0 && tr_s <= m_top[component_idx]) [[likely]]
+    // Field 0 has the even lines of the frame, field 1 the odd ones; the frame height is even with interlaced=true.
+    for (int field{0}; field < 2; ++field)
     {
-        for (int x{0}; x < plane_width; ++x)
-        {
-            T_Pixel* AVS_RESTRICT const plane_ptr_col_start{dstp + x};
-
-            switch (m_ts_mode_runtime)
-            {
-            case 0:
-                smooth_lerp_top_impl(plane_ptr_col_start, plane_height, stride, m_top[component_idx], tr_s, bits, lerp_plane_idx_param);
-                break;
-            case 1:
-                smooth_gaussian_vertical_impl(plane_ptr_col_start, plane_height, stride, m_top[component_idx], tr_s, true, temp_buf, false);
-                break;
-            case 2:
-                smooth_gaussian_vertical_impl(plane_ptr_col_start, plane_height, stride, m_top[component_idx], tr_s, true, temp_buf, true);
-                break;
-            }
-        }
+        g.top[field] = derive_detected((m_interlaced) ? (borders[SIDE_TOP] + 1 - field) / 2 : borders[SIDE_TOP], m_subsample_shift_h);
+        g.bottom[field] = derive_detected((m_interlaced) ? (borders[SIDE_BOTTOM] + field) / 2 : borders[SIDE_BOTTOM], m_subsample_shift_h);
     }
 
-    if (m_bottom[component_idx] > 0 && tr_s <= m_bottom[component_idx]) [[likely]]
+    // Transient smoothing needs borders of at least ts.
+    if constexpr (MODE_VAL == 4)
     {
-        for (int x{0}; x < plane_width; ++x)
+        if (m_ts_runtime > 0)
         {
-            T_Pixel* AVS_RESTRICT const plane_ptr_col_start{dstp + x};
-
-            switch (m_ts_mode_runtime)
+            for (std::array<int, 4>* side : {&g.left, &g.top[0], &g.top[1], &g.right, &g.bottom[0], &g.bottom[1]})
             {
-            case 0:
-                smooth_lerp_bottom_impl(
-                    plane_ptr_col_start, plane_height, stride, m_bottom[component_idx], tr_s, bits, lerp_plane_idx_param);
-                break;
-            case 1:
-                smooth_gaussian_vertical_impl(
-                    plane_ptr_col_start, plane_height, stride, m_bottom[component_idx], tr_s, false, temp_buf, false);
-                break;
-            case 2:
-                smooth_gaussian_vertical_impl(
-                    plane_ptr_col_start, plane_height, stride, m_bottom[component_idx], tr_s, false, temp_buf, true);
-                break;
+                for (int& value : *side)
+                {
+                    if (value > 0 && value < m_ts_runtime)
+                        value = m_ts_runtime;
+                }
             }
         }
     }
-}
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_left_impl(T_Pixel* AVS_RESTRICT row_ptr, const int plane_width,
-    const int border_size, const int tr_s, const int bits, const int lerp_plane_idx_param) const noexcept
-{
-    if (border_size == 0 || tr_s == 0) [[unlikely]]
-        return;
-
-    const int actual_tr_size{std::min(border_size, tr_s)};
+    const std::shared_ptr<const geometry> detected{cached_geometry(std::move(g), env)};
 
-    if (actual_tr_size == 0) [[unlikely]]
-        return;
+    std::lock_guard<std::mutex> lock{m_detected_windows_mutex};
 
-    const T_Calc original_edge_val{static_cast<T_Calc>(row_ptr[border_size])};
-    const int anchor_x{border_size - actual_tr_size - 1};
-    const T_Calc anchor_val{(anchor_x < 0) ? static_cast<T_Calc>(row_ptr[0]) : static_cast<T_Calc>(row_ptr[anchor_x])};
+    if (m_detected_windows.size() == GEOMETRY_CACHE_SIZE)
+        m_detected_windows.erase(m_detected_windows.begin());
 
-    for (int k{0}; k < actual_tr_size; ++k)
-    {
-        const int x_to_change{border_size - actual_tr_size + k};
-        const int lerp_pos{k + 1};
-        row_ptr[x_to_change] =
-            lerp<T_Pixel, T_Calc>(original_edge_val, anchor_val, lerp_pos, actual_tr_size + 1, bits, lerp_plane_idx_param);
-    }
+    m_detected_windows.emplace_back(window, detected);
+    return detected;
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_right_impl(T_Pixel* AVS_RESTRICT row_ptr, const int plane_width,
-    const int border_size, const int tr_s, const int bits, const int lerp_plane_idx_param) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto FillBorders<T_Pixel, T_Calc, MODE_VAL>::frame_mask_spans(const int n, IScriptEnvironment* env) const
+    -> std::shared_ptr<const mask_spans>
 {
-    if (border_size == 0 || tr_s == 0) [[unlikely]]
-        return;
+    const VideoInfo& mask_vi{m_mask->GetVideoInfo()};
+    // A mask shorter than the clip repeats its last frame, e.g. a single image.
+    const PVideoFrame mask_frame{m_mask->GetFrame(std::min(n, mask_vi.num_frames - 1), env)};
+    const int num_mask_planes{(mask_vi.IsY()) ? 1 : vi.NumComponents()};
+    const int* const plane_constants{plane_order(mask_vi)};
 
-    const int actual_tr_size{std::min(border_size, tr_s)};
+    std::lock_guard<std::mutex> lock{m_mask_mutex};
 
-    if (actual_tr_size == 0) [[unlikely]]
-        return;
-
-    const T_Calc original_edge_val{static_cast<T_Calc>(row_ptr[plane_width - border_size - 1])};
-    const int anchor_x{plane_width - border_size + actual_tr_size};
-    const T_Calc anchor_val{
-        (anchor_x >= plane_width) ? static_cast<T_Calc>(row_ptr[plane_width - 1]) : static_cast<T_Calc>(row_ptr[anchor_x])};
-
-    for (int k{0}; k < actual_tr_size; ++k)
+    if (m_mask_spans) [[likely]]
     {
-        const int x_to_change{plane_width - border_size + k};
-        const int lerp_pos{actual_tr_size - k};
-        row_ptr[x_to_change] =
-            lerp<T_Pixel, T_Calc>(original_edge_val, anchor_val, lerp_pos, actual_tr_size + 1, bits, lerp_plane_idx_param);
-    }
-}
-
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_top_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start, const int plane_height,
-    const size_t stride, const int border_size, const int tr_s, const int bits, const int lerp_plane_idx_param) const noexcept
-{
-    if (border_size == 0 || tr_s == 0) [[unlikely]]
-        return;
+        bool same_frame{true};
+        bool same_samples{true};
 
-    const int actual_tr_size{std::min(border_size, tr_s)};
+        for (int i{0}; i < num_mask_planes; ++i)
+            same_frame = same_frame && mask_frame->GetReadPtr(plane_constants[i]) == m_mask_frame->GetReadPtr(plane_constants[i]);
 
-    if (actual_tr_size == 0) [[unlikely]]
-        return;
+        // A static mask is often a new frame with the same samples.
+        for (int i{0}; i < num_mask_planes && !same_frame && same_samples; ++i)
+        {
+            const int plane{plane_constants[i]};
+            const int row_size{mask_frame->GetRowSize(plane)};
 
-    const T_Calc original_edge_val{static_cast<T_Calc>(plane_ptr_col_start[static_cast<int64_t>(border_size) * stride])};
-    const int anchor_y{border_size - actual_tr_size - 1};
-    const T_Calc anchor_val{(anchor_y < 0) ? static_cast<T_Calc>(plane_ptr_col_start[0])
-                                           : static_cast<T_Calc>(plane_ptr_col_start[static_cast<int64_t>(anchor_y) * stride])};
+            for (int y{0}; y < mask_frame->GetHeight(plane) && same_samples; ++y)
+                same_samples = !std::memcmp(mask_frame->GetReadPtr(plane) + static_cast<int64_t>(y) * mask_frame->GetPitch(plane),
+                    m_mask_frame->GetReadPtr(plane) + static_cast<int64_t>(y) * m_mask_frame->GetPitch(plane), row_size);
+        }
 
-    for (int k{0}; k < actual_tr_size; ++k)
-    {
-        const int y_to_change{border_size - actual_tr_size + k};
-        const int lerp_pos{k + 1};
-        plane_ptr_col_start[static_cast<int64_t>(y_to_change) * stride] =
-            lerp<T_Pixel, T_Calc>(original_edge_val, anchor_val, lerp_pos, actual_tr_size + 1, bits, lerp_plane_idx_param);
+        if (same_frame || same_samples)
+            return m_mask_spans;
     }
-}
-
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_bottom_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start,
-    const int plane_height, const size_t stride, const int border_size, const int tr_s, const int bits,
-    const int lerp_plane_idx_param) const noexcept
-{
-    if (border_size == 0 || tr_s == 0) [[unlikely]]
-        return;
-
-    const int actual_tr_size{std::min(border_size, tr_s)};
-
-    if (actual_tr_size == 0) [[unlikely]]
-        return;
 
-    const T_Calc original_edge_val{static_cast<T_Calc>(plane_ptr_col_start[static_cast<int64_t>(plane_height - border_size - 1) * stride])};
-    const int anchor_y{plane_height - border_size + actual_tr_size};
-    const T_Calc anchor_val{(anchor_y >= plane_height)
-                                ? static_cast<T_Calc>(plane_ptr_col_start[static_cast<int64_t>(plane_height - 1) * stride])
-                                : static_cast<T_Calc>(plane_ptr_col_start[static_cast<int64_t>(anchor_y) * stride])};
+    auto spans{std::make_shared<mask_spans>()};
 
-    for (int k{0}; k < actual_tr_size; ++k)
+    for (int i{0}; i < vi.NumComponents(); ++i)
     {
-        const int y_to_change{plane_height - border_size + k};
-        const int lerp_pos{actual_tr_size - k};
-        plane_ptr_col_start[static_cast<int64_t>(y_to_change) * stride] =
-            lerp<T_Pixel, T_Calc>(original_edge_val, anchor_val, lerp_pos, actual_tr_size + 1, bits, lerp_plane_idx_param);
+        const int plane{plane_constants[(mask_vi.IsY()) ? 0 : i]};
+        const bool chroma{i == 1 || i == 2};
+        const int width{(chroma) ? vi.width >> m_subsample_shift_w : vi.width};
+        const int height{(chroma) ? vi.height >> m_subsample_shift_h : vi.height};
+        // A greyscale mask covers 1 << subsample_shift samples of the subsampled planes, the planes of a planar mask have the size of
+        // the planes of the clip.
+        const int shift_w{(chroma && mask_vi.IsY()) ? m_subsample_shift_w : 0};
+        const int shift_h{(chroma && mask_vi.IsY()) ? m_subsample_shift_h : 0};
+        const uint8_t* const maskp{mask_frame->GetReadPtr(plane)};
+        const int stride{mask_frame->GetPitch(plane) / mask_vi.ComponentSize()};
+
+        if (mask_vi.ComponentSize() == 1)
+            (*spans)[i] = build_mask_spans(maskp, stride, width, height, shift_w, shift_h);
+        else if (mask_vi.ComponentSize() == 2)
+            (*spans)[i] = build_mask_spans(reinterpret_cast<const uint16_t*>(maskp), stride, width, height, shift_w, shift_h);
+        else
+            (*spans)[i] = build_mask_spans(reinterpret_cast<const float*>(maskp), stride, width, height, shift_w, shift_h);
     }
+
+    m_mask_frame = mask_frame;
+    m_mask_spans = std::move(spans);
+    return m_mask_spans;
 }
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_gaussian_horizontal_impl(T_Pixel* AVS_RESTRICT row_ptr, const int plane_width,
-    const int border_size, const int tr_s, const bool is_left_border, T_Pixel* AVS_RESTRICT temp_buf,
-    const bool modify_original_pixels) const noexcept
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto FillBorders<T_Pixel, T_Calc, MODE_VAL>::recent_edges(const int n, const geometry& g, const frame_planes& current,
+    IScriptEnvironment* env) const -> std::vector<std::shared_ptr<const std::vector<T_Pixel>>>
 {
-    if (border_size == 0 || tr_s == 0 || plane_width == 0) [[unlikely]]
-        return;
-
-    const int actual_tr_size_for_op{std::min(border_size, tr_s)};
+    const int first_frame{std::max(n - m_temporal_frames + 1, 0)};
+    const size_t num_samples{m_core.edge_samples(g)};
+    // [frame - first_frame], the current frame is last.
+    std::vector<std::shared_ptr<const std::vector<T_Pixel>>> edges(static_cast<size_t>(n) - first_frame + 1);
+    std::vector<int> missing_frames;
 
-    if (actual_tr_size_for_op == 0) [[unlikely]]
-        return;
-
-    const int conv_window_full_width{actual_tr_size_for_op * 2};
-
-    if (conv_window_full_width > MAX_TSIZE) [[unlikely]]
-        return;
-
-    const int conv_window_start_x_in_row{
-        (is_left_border) ? (border_size - actual_tr_size_for_op) : (plane_width - border_size - actual_tr_size_for_op)};
-
-    for (int xp{0}; xp < conv_window_full_width; ++xp)
     {
-        const int current_center_x_in_row{conv_window_start_x_in_row + xp};
-        T_Calc sum{0};
+        std::lock_guard<std::mutex> lock{m_temporal_mutex};
 
-        for (int k_idx{0}; k_idx < TS_KERNELSIZE; ++k_idx)
+        for (int frame_n{first_frame}; frame_n < n; ++frame_n)
         {
-            const int sample_x{current_center_x_in_row + k_idx - (TS_KERNELSIZE / 2)};
-            T_Pixel sample_val{[&]() {
-                if (sample_x < 0) [[unlikely]]
-                    return row_ptr[0];
-                else if (sample_x >= plane_width) [[unlikely]]
-                    return row_ptr[plane_width - 1];
-                else [[likely]]
-                    return row_ptr[sample_x];
-            }()};
-
-            sum += static_cast<T_Calc>(sample_val) * m_ts_kernel_data[k_idx];
-        }
+            const auto& [cached_n, cached_edges]{m_temporal_edges[frame_n % m_temporal_frames]};
 
-        if constexpr (std::is_integral_v<T_Pixel>)
-            temp_buf[xp] = static_cast<T_Pixel>(sum);
-        else
-            temp_buf[xp] = sum;
+            if (cached_n == frame_n)
+                edges[frame_n - first_frame] = cached_edges;
+            else
+                missing_frames.push_back(frame_n);
+        }
     }
 
-    int write_start_x_in_row_final;
-    int temp_buf_read_offset_final;
-    int num_pixels_to_write_final;
+    const auto extract{[&](const frame_planes& planes) {
+        auto frame_edges{std::make_shared<std::vector<T_Pixel>>(num_samples)};
+        m_core.extract_edges(g, planes, frame_edges->data());
+        return frame_edges;
+    }};
 
-    if (modify_original_pixels)
+    // The missing frames are requested oldest first, like a linear access, so that they are usually still in the cache of the source
+    // clip. With a linear access only the current frame is new.
+    for (const int frame_n : missing_frames)
     {
-        write_start_x_in_row_final = conv_window_start_x_in_row;
-        temp_buf_read_offset_final = 0;
-        num_pixels_to_write_final = conv_window_full_width;
-    }
-    else
-    {
-        if (is_left_border)
-        {
-            write_start_x_in_row_final = border_size - actual_tr_size_for_op;
-            temp_buf_read_offset_final = 0;
-        }
-        else
+        const PVideoFrame frame{child->GetFrame(frame_n, env)};
+        const int* const plane_constants{plane_order(vi)};
+        frame_planes planes{};
+
+        for (int i{0}; i < vi.NumComponents(); ++i)
         {
-            write_start_x_in_row_final = plane_width - border_size;
-            temp_buf_read_offset_final = actual_tr_size_for_op;
+            planes.srcp[i] = frame->GetReadPtr(plane_constants[i]);
+            planes.src_stride[i] = frame->GetPitch(plane_constants[i]);
         }
 
-        num_pixels_to_write_final = actual_tr_size_for_op;
-    }
-
-    for (int k{0}; k < num_pixels_to_write_final; ++k)
-    {
-        const int x_to_change{write_start_x_in_row_final + k};
-
-        if (x_to_change >= 0 && x_to_change < plane_width) [[likely]]
-            row_ptr[x_to_change] = temp_buf[temp_buf_read_offset_final + k];
+        edges[frame_n - first_frame] = extract(planes);
     }
-}
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_gaussian_vertical_impl(T_Pixel* AVS_RESTRICT plane_ptr_col_start,
-    const int plane_height, const size_t stride, const int border_size, const int tr_s, const bool is_top_border,
-    T_Pixel* AVS_RESTRICT temp_buf, const bool modify_original_pixels) const noexcept
-{
-    if (border_size == 0 || tr_s == 0 || plane_height == 0) [[unlikely]]
-        return;
+    edges.back() = extract(current);
+    missing_frames.push_back(n);
 
-    const int actual_tr_size_for_op{std::min(border_size, tr_s)};
+    std::lock_guard<std::mutex> lock{m_temporal_mutex};
 
-    if (actual_tr_size_for_op == 0) [[unlikely]]
-        return;
+    for (const int frame_n : missing_frames)
+        m_temporal_edges[frame_n % m_temporal_frames] = {frame_n, edges[frame_n - first_frame]};
 
-    const int conv_window_full_width{actual_tr_size_for_op * 2};
-
-    if (conv_window_full_width > MAX_TSIZE) [[unlikely]]
-        return;
+    return edges;
+}
 
-    int conv_window_start_y_in_col{
-        (is_top_border) ? (border_size - actual_tr_size_for_op) : (plane_height - border_size - actual_tr_size_for_op)};
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+PVideoFrame __stdcall FillBorders<T_Pixel, T_Calc, MODE_VAL>::GetFrame(int n, IScriptEnvironment* env)
+{
+    PVideoFrame src_frame{child->GetFrame(n, env)};
 
-    for (int yp{0}; yp < conv_window_full_width; ++yp)
+    if (!m_interlaced) [[likely]]
     {
-        const int current_center_y_in_col{conv_window_start_y_in_col + yp};
-        T_Calc sum{0};
-
-        for (int k_idx{0}; k_idx < TS_KERNELSIZE; ++k_idx)
+        if (has_at_least_v8) [[likely]]
         {
-            const int sample_y{current_center_y_in_col + k_idx - (TS_KERNELSIZE / 2)};
-            T_Pixel sample_val{[&]() {
-                if (sample_y < 0) [[unlikely]]
-                    return plane_ptr_col_start[0 * stride];
-                else if (sample_y >= plane_height) [[unlikely]]
-                    return plane_ptr_col_start[static_cast<int64_t>(plane_height - 1) * stride];
-                else [[likely]]
-                    return plane_ptr_col_start[static_cast<int64_t>(sample_y) * stride];
-            }()};
-
-            sum += static_cast<T_Calc>(sample_val) * m_ts_kernel_data[k_idx];
-        }
-
-        if constexpr (std::is_integral_v<T_Pixel>)
-            temp_buf[yp] = static_cast<T_Pixel>(sum);
-        else
-            temp_buf[yp] = sum;
-    }
+            const AVSMap* props{env->getFramePropsRO(src_frame)};
 
-    int write_start_y_in_col_final;
-    int temp_buf_read_offset_final;
-    int num_pixels_to_write_final;
+            if (env->propNumElements(props, "_FieldBased") > 0)
+            {
+                const int64_t field_based{env->propGetInt(props, "_FieldBased", 0, nullptr)};
 
-    if (modify_original_pixels)
-    {
-        write_start_y_in_col_final = conv_window_start_y_in_col;
-        temp_buf_read_offset_final = 0;
-        num_pixels_to_write_final = conv_window_full_width;
-    }
-    else
-    {
-        if (is_top_border)
-        {
-            write_start_y_in_col_final = border_size - actual_tr_size_for_op;
-            temp_buf_read_offset_final = 0;
-        }
-        else
-        {
-            write_start_y_in_col_final = plane_height - border_size;
-            temp_buf_read_offset_final = actual_tr_size_for_op;
+                if (field_based > 0) [[unlikely]]
+                    env->ThrowError("FillBorders: frame must be not interlaced or use interlaced=true.");
+            }
         }
-
-        num_pixels_to_write_final = actual_tr_size_for_op;
     }
 
-    for (int k{0}; k < num_pixels_to_write_final; ++k)
-    {
-        const int y_to_change{write_start_y_in_col_final + k};
+    std::shared_ptr<const geometry> frame_g{(m_autodetect_window > 0) ? detected_geometry(n, env) : m_geometry};
 
-        if (y_to_change >= 0 && y_to_change < plane_height) [[likely]]
-        {
-            int rrr{4};
-            plane_ptr_col_start[static_cast<int64_t>(y_to_change) * stride] = temp_buf[temp_buf_read_offset_final + k];
-        }
-    }
-}
+    if (m_borders_from_props)
+        frame_g = frame_geometry(frame_g, env->getFramePropsRO(src_frame), env);
 
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_5_fade_impl(T_Pixel* AVS_RESTRICT dstp, const int plane_width,
-    const int plane_height, const size_t stride, const int component_idx, const int bits, const int lerp_plane_idx_param) const noexcept
-{
-    if (plane_width == 0 || plane_height == 0) [[unlikely]]
-        return;
+    const geometry& g{*frame_g};
 
-    const int current_m_top{m_top[component_idx]};
-    const int current_m_bottom{m_bottom[component_idx]};
-    const int current_m_left{m_left[component_idx]};
-    const int current_m_right{m_right[component_idx]};
+    // Nothing to fill, the source frame is returned as is. With autodetect the frame still gets the detected sizes as properties.
+    if (g.empty && m_autodetect_window == 0 && m_regions.empty() && !m_mask)
+        return src_frame;
 
-    const bool use_constant_target = m_fade_target_value.has_value();
-    const T_Calc constant_target_value_for_this_component{
-        use_constant_target ? (*m_fade_target_value)[component_idx] : static_cast<T_Calc>(0)};
+    const std::shared_ptr<const mask_spans> spans{(m_mask) ? frame_mask_spans(n, env) : nullptr};
 
-    if (current_m_top > 0) [[likely]]
-    {
-        for (int y_fill{0}; y_fill < current_m_top; ++y_fill)
-        {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y_fill) * stride};
-            const T_Pixel* AVS_RESTRICT const first_row_ptr{dstp};
+    // Only the borders are modified, so a uniquely owned source frame is filled in place instead of being copied.
+    const bool in_place{src_frame->IsWritable()};
+    PVideoFrame dst_frame{
+        (in_place) ? PVideoFrame{} : ((has_at_least_v8) ? env->NewVideoFrameP(vi, &src_frame) : env->NewVideoFrame(vi))};
+    PVideoFrame& out_frame{(in_place) ? src_frame : dst_frame};
 
-            for (int x_col{0}; x_col < plane_width; ++x_col)
-                current_row_ptr[x_col] = lerp<T_Pixel, T_Calc>(
-                    (use_constant_target) ? constant_target_value_for_this_component : static_cast<T_Calc>(first_row_ptr[x_col]),
-                    static_cast<T_Calc>(current_row_ptr[x_col]), current_m_top - y_fill, current_m_top, bits, lerp_plane_idx_param);
-        }
-    }
+    fill_stats stats{};
+    fill_stats* const frame_stats{(m_stats) ? &stats : nullptr};
+    const auto start{(m_stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
 
-    if (current_m_bottom > 0) [[likely]]
+    if (m_packed_layout)
     {
-        const int start_bottom_fill_y{plane_height - current_m_bottom};
+        const uint8_t* srcp{src_frame->GetReadPtr()};
+        int src_stride{src_frame->GetPitch()};
+        uint8_t* dstp{out_frame->GetWritePtr()};
+        int dst_stride{out_frame->GetPitch()};
 
-        for (int y_fill{start_bottom_fill_y}; y_fill < plane_height; ++y_fill)
+        // Packed RGB is stored bottom-up.
+        if (vi.IsRGB())
         {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y_fill) * stride};
-            const T_Pixel* AVS_RESTRICT const first_row_ptr{dstp};
-
-            for (int x_col{0}; x_col < plane_width; ++x_col)
-                current_row_ptr[x_col] = lerp<T_Pixel, T_Calc>(
-                    (use_constant_target) ? constant_target_value_for_this_component : static_cast<T_Calc>(first_row_ptr[x_col]),
-                    static_cast<T_Calc>(current_row_ptr[x_col]), y_fill - start_bottom_fill_y, current_m_bottom, bits,
-                    lerp_plane_idx_param);
+            srcp += static_cast<int64_t>(vi.height - 1) * src_stride;
+            src_stride = -src_stride;
+            dstp += static_cast<int64_t>(vi.height - 1) * dst_stride;
+            dst_stride = -dst_stride;
         }
-    }
 
-    if (current_m_left > 0) [[likely]]
-    {
-        for (int y_row{0}; y_row < plane_height; ++y_row)
-        {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y_row) * stride};
-
-            for (int x_border_col{0}; x_border_col < current_m_left; ++x_border_col)
-            {
-                const T_Calc target_val_from_row0{static_cast<T_Calc>(dstp[x_border_col])};
-                current_row_ptr[x_border_col] =
-                    lerp<T_Pixel, T_Calc>((use_constant_target) ? constant_target_value_for_this_component : target_val_from_row0,
-                        static_cast<T_Calc>(current_row_ptr[x_border_col]), current_m_left - x_border_col, current_m_left, bits,
-                        lerp_plane_idx_param);
-            }
-        }
+        m_core.fill_packed(g, *m_packed_layout, srcp, src_stride, dstp, dst_stride, frame_stats);
     }
-
-    if (current_m_right > 0) [[likely]]
+    else
     {
-        const int start_right_fill_x{plane_width - current_m_right};
-
-        for (int y_row{0}; y_row < plane_height; ++y_row)
-        {
-            T_Pixel* AVS_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y_row) * stride};
-
-            for (int x_offset_in_border{0}; x_offset_in_border < current_m_right; ++x_offset_in_border)
-            {
-                const int x_col_to_fill{start_right_fill_x + x_offset_in_border};
-                const T_Calc target_val_from_row0{static_cast<T_Calc>(dstp[x_offset_in_border])};
-                current_row_ptr[x_col_to_fill] = lerp<T_Pixel, T_Calc>(
-                    (use_constant_target) ? constant_target_value_for_this_component : target_val_from_row0,
-                    static_cast<T_Calc>(current_row_ptr[x_col_to_fill]), x_offset_in_border, current_m_right, bits, lerp_plane_idx_param);
-            }
-        }
-    }
-}
-
-template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
-void FillBorders<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_6_fixborders_impl(
-    T_Pixel* AVS_RESTRICT dstp, const int plane_width, const int plane_height, const size_t stride, const int component_idx) const noexcept
-{
-    if (plane_width == 0 || plane_height == 0) [[unlikely]]
-        return;
-
-    const int current_m_left{m_left[component_idx]};
-    const int current_m_top{m_top[component_idx]};
-    const int current_m_right{m_right[component_idx]};
-    const int current_m_bottom{m_bottom[component_idx]};
-
-    // These define how many rows/cols near the main edges are simply copied before complex averaging
-    const int top_copy_zone_height{current_m_top + 3};
-    const int bottom_copy_zone_height{current_m_bottom + 3};
-
-    auto calculate_mode6_pixel{[](T_Calc prev_p, T_Calc cur_p, T_Calc next_p, T_Calc ref_prev_p, T_Calc ref_cur_p, T_Calc ref_next_p,
-                                   T_Calc far_ref_prev_blur_term, T_Calc far_ref_next_blur_term) -> T_Pixel {
-        T_Calc fill_prev, fill_cur, fill_next;
+        const int* const plane_constants{plane_order(vi)};
+        frame_planes planes{};
 
-        if constexpr (std::is_integral_v<T_Pixel>)
+        for (int i{0}; i < vi.NumComponents(); ++i)
         {
-            fill_prev = static_cast<T_Calc>(std::llrint(
-                (5.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 1.0 * static_cast<double>(next_p)) / 9.0));
-            fill_cur = static_cast<T_Calc>(std::llrint(
-                (1.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 1.0 * static_cast<double>(next_p)) / 5.0));
-            fill_next = static_cast<T_Calc>(std::llrint(
-                (1.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 5.0 * static_cast<double>(next_p)) / 9.0));
+            const int current_plane{plane_constants[i]};
+            planes.srcp[i] = src_frame->GetReadPtr(current_plane);
+            planes.src_stride[i] = src_frame->GetPitch(current_plane);
+            planes.dstp[i] = out_frame->GetWritePtr(current_plane);
+            planes.dst_stride[i] = out_frame->GetPitch(current_plane);
         }
-        else
-        {
-            fill_prev = (5 * prev_p + 3 * cur_p + next_p) / static_cast<T_Calc>(9.0);
-            fill_cur = (prev_p + 3 * cur_p + next_p) / static_cast<T_Calc>(5.0);
-            fill_next = (prev_p + 3 * cur_p + 5 * next_p) / static_cast<T_Calc>(9.0);
-        }
-
-        const T_Calc blur_prev_val{(2 * ref_prev_p + ref_cur_p + far_ref_prev_blur_term) / static_cast<T_Calc>(4.0)};
-        const T_Calc blur_next_val{(2 * ref_next_p + ref_cur_p + far_ref_next_blur_term) / static_cast<T_Calc>(4.0)};
 
-        const T_Calc diff_next_calc{std::abs(ref_next_p - fill_cur)};
-        const T_Calc diff_prev_calc{std::abs(ref_prev_p - fill_cur)};
-        const T_Calc thr_next_calc{std::abs(ref_next_p - blur_next_val)};
-        const T_Calc thr_prev_calc{std::abs(ref_prev_p - blur_prev_val)};
+        m_core.fill(g, planes, frame_stats);
 
-        if (diff_next_calc > thr_next_calc)
-            return (diff_prev_calc < diff_next_calc) ? static_cast<T_Pixel>(fill_prev) : static_cast<T_Pixel>(fill_next);
-        else if (diff_prev_calc > thr_prev_calc)
-            return static_cast<T_Pixel>(fill_next);
-        else
-            return static_cast<T_Pixel>(fill_cur);
-    }};
-
-    // --- Left Side Processing ---
-    if (current_m_left > 0) [[likely]]
-    {
-        for (int x_fill{current_m_left - 1}; x_fill >= 0; --x_fill)
+        if constexpr (MODE_VAL == 7)
         {
-            const int x_ref1{x_fill + 1};
-            const int x_ref2{x_fill + 2};
+            const std::vector<std::shared_ptr<const std::vector<T_Pixel>>> edges{recent_edges(n, g, planes, env)};
+            std::vector<const T_Pixel*> edge_ptrs;
 
-            if (x_ref1 >= plane_width) [[unlikely]]
-            {
-                if (x_fill + 1 < plane_width)
-                {
-                    for (int y{0}; y < plane_height; ++y)
-                        dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_fill + 1];
-                }
+            for (const auto& frame_edges : edges)
+                edge_ptrs.push_back(frame_edges->data());
 
-                continue;
-            }
-
-            // 1. Direct copy for top and bottom edge zones of this column
-            for (int y{0}; y < top_copy_zone_height; ++y)
-            {
-                if (y < plane_height) [[likely]]
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-            }
-
-            for (int y_offset_from_bottom{bottom_copy_zone_height}; y_offset_from_bottom > 0; --y_offset_from_bottom)
-            {
-                const int y{plane_height - y_offset_from_bottom};
+            m_core.fill_temporal(g, planes, edge_ptrs, m_temporal_median, frame_stats);
+        }
 
-                if (y >= 0 && y < plane_height) [[likely]]
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-            }
+        for (const auto& region : m_regions)
+            region->fill(planes, frame_stats);
 
-            // 2. Weighted average for the middle part of this column
-            if (x_ref2 < plane_width) [[likely]]
-            {
-                for (int y{top_copy_zone_height}; y < plane_height - bottom_copy_zone_height; ++y)
-                {
-                    // Ensure y-2 and y+2 are valid for blur calculation's furthest lookups
-                    if (y - 2 < 0 || y + 2 >= plane_height) [[unlikely]]
-                    {
-                        // Fallback for y too close to top/bottom for full 5-row context: simple copy
-                        dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-                        continue;
-                    }
-
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] =
-                        calculate_mode6_pixel(static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 1) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 1) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 1) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 1) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 2) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 2) * stride + x_ref2]));
-                }
-            }
-            else
-            { // x_ref2 is out of bounds, so just copy for the middle part too
-                for (int y{top_copy_zone_height}; y < plane_height - bottom_copy_zone_height; ++y)
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-            }
-        }
+        if (spans)
+            m_core.fill_masked(*spans, planes, frame_stats);
     }
 
-    // --- Right Side Processing ---
-    if (current_m_right > 0) [[likely]]
-    {
-        for (int x_fill{plane_width - current_m_right}; x_fill < plane_width; ++x_fill)
-        {
-            const int x_ref1{x_fill - 1};
-            const int x_ref2{x_fill - 2}; // x-2 column
-
-            if (x_ref1 < 0) [[unlikely]]
-            {
-                if (x_fill - 1 >= 0)
-                {
-                    for (int y{0}; y < plane_height; ++y)
-                        dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_fill - 1];
-                }
+    const int64_t frame_ns{
+        (m_stats) ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() : 0};
 
-                continue;
-            }
+    if (m_stats) [[unlikely]]
+        m_stats->add(frame_ns, stats);
 
-            for (int y{0}; y < top_copy_zone_height; ++y)
-            {
-                if (y < plane_height) [[likely]]
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-            }
+    if (has_at_least_v8)
+    {
+        AVSMap* props{env->getFramePropsRW(out_frame)};
+        env->propSetInt(props, "_FillBorders_InPlace", in_place, 0);
 
-            for (int y_offset_from_bottom{bottom_copy_zone_height}; y_offset_from_bottom > 0; --y_offset_from_bottom)
-            {
-                const int y{plane_height - y_offset_from_bottom};
+        if (m_autodetect_window > 0)
+        {
+            const auto set_border_prop{[&](const char* prop_name, const std::array<int, 4>& border) {
+                const std::array<int64_t, 4> values{border[0], border[1], border[2], border[3]};
+                env->propSetIntArray(props, prop_name, values.data(), vi.NumComponents());
+            }};
 
-                if (y >= 0 && y < plane_height) [[likely]]
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-            }
+            set_border_prop("_FillBorders_Left", g.left);
+            set_border_prop("_FillBorders_Top", g.top[0]);
+            set_border_prop("_FillBorders_Right", g.right);
+            set_border_prop("_FillBorders_Bottom", g.bottom[0]);
 
-            if (x_ref2 >= 0) [[likely]]
+            if (m_interlaced)
             {
-                for (int y{top_copy_zone_height}; y < plane_height - bottom_copy_zone_height; ++y)
-                {
-                    if (y - 2 < 0 || y + 2 >= plane_height) [[unlikely]]
-                    {
-                        dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
-                        continue;
-                    }
-
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] =
-                        calculate_mode6_pixel(static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 1) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 1) * stride + x_ref1]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 1) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 1) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y - 2) * stride + x_ref2]),
-                            static_cast<T_Calc>(dstp[static_cast<int64_t>(y + 2) * stride + x_ref2]));
-                }
-            }
-            else
-            {
-                for (int y{top_copy_zone_height}; y < plane_height - bottom_copy_zone_height; ++y)
-                    dstp[static_cast<int64_t>(y) * stride + x_fill] = dstp[static_cast<int64_t>(y) * stride + x_ref1];
+                set_border_prop("_FillBorders_Top2", g.top[1]);
+                set_border_prop("_FillBorders_Bottom2", g.bottom[1]);
             }
         }
-    }
 
-    // --- Top Side Processing ---
-    if (current_m_top > 0) [[likely]]
-    {
-        for (int y_fill{current_m_top - 1}; y_fill >= 0; --y_fill)
+        if (m_stats) [[unlikely]]
         {
-            const int64_t y_fill_s{static_cast<int64_t>(y_fill)};
-            const int64_t y_ref1_s{static_cast<int64_t>(y_fill + 1)}; // y+1 row
-            const int64_t y_ref2_s{static_cast<int64_t>(y_fill + 2)}; // y+2 row
-
-            if (y_ref1_s >= plane_height) [[unlikely]]
-                continue;
+            const auto set_plane_prop{[&](const char* prop_name, const auto& plane_values) {
+                std::array<int64_t, 4> values{};
 
-            // 1. Direct copy for left and right edge zones of this row
-            if (plane_width > 0)
-                dstp[y_fill_s * stride + 0] = dstp[y_ref1_s * stride + 0];
+                for (int i{0}; i < 4; ++i)
+                    values[i] = plane_values[i];
 
-            if (plane_width > 1)
-            { // Last 8 pixels (or fewer)
-                const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+                env->propSetIntArray(props, prop_name, values.data(), vi.NumComponents());
+            }};
 
-                if (num_edge_pixels_to_copy > 0)
-                    std::memcpy(dstp + y_fill_s * stride + plane_width - num_edge_pixels_to_copy,
-                        dstp + y_ref1_s * stride + plane_width - num_edge_pixels_to_copy,
-                        static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
-            }
-
-            // 2. Weighted average for the middle part of this row
-            if (y_ref2_s < plane_height) [[likely]]
-            { // Ensure y+2 is valid
-                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-                {
-                    // Clamp x-references for edge cases instead of skipping
-                    const int x_prev_clamped{std::max(0, x - 1)};
-                    const int x_next_clamped{std::min(plane_width - 1, x + 1)};
-                    const int x_prev2_clamped{std::max(0, x - 2)};
-                    const int x_next2_clamped{std::min(plane_width - 1, x + 2)};
-
-                    dstp[y_fill_s * stride + x] = calculate_mode6_pixel(static_cast<T_Calc>(dstp[y_ref1_s * stride + x_prev_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref1_s * stride + x]), static_cast<T_Calc>(dstp[y_ref1_s * stride + x_next_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev_clamped]), static_cast<T_Calc>(dstp[y_ref2_s * stride + x]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev2_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next2_clamped]));
-                }
-            }
-            else
-            { // y_ref2 is out of bounds, just copy for the middle part too
-                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-                    dstp[y_fill_s * stride + x] = dstp[y_ref1_s * stride + x];
-            }
+            env->propSetInt(props, "_FillBorders_FrameNs", frame_ns, 0);
+            set_plane_prop("_FillBorders_CopyNs", stats.copy_ns);
+            set_plane_prop("_FillBorders_FillNs", stats.fill_ns);
+            set_plane_prop("_FillBorders_BytesRead", stats.bytes_read);
+            set_plane_prop("_FillBorders_BytesWritten", stats.bytes_written);
         }
     }
 
-    // --- Bottom Side Processing ---
-    if (current_m_bottom > 0) [[likely]]
-    {
-        for (int y_fill{plane_height - current_m_bottom}; y_fill < plane_height; ++y_fill)
-        {
-            const int64_t y_fill_s{static_cast<int64_t>(y_fill)};
-            const int64_t y_ref1_s{static_cast<int64_t>(y_fill - 1)}; // y-1 row
-            const int64_t y_ref2_s{static_cast<int64_t>(y_fill - 2)}; // y-2 row
-
-            if (y_ref1_s < 0) [[unlikely]]
-                continue;
-
-            if (plane_width > 0)
-                dstp[y_fill_s * stride + 0] = dstp[y_ref1_s * stride + 0];
-
-            if (plane_width > 1)
-            {
-                const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
-
-                if (num_edge_pixels_to_copy > 0)
-                    std::memcpy(dstp + y_fill_s * stride + plane_width - num_edge_pixels_to_copy,
-                        dstp + y_ref1_s * stride + plane_width - num_edge_pixels_to_copy,
-                        static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
-            }
-
-            if (y_ref2_s >= 0) [[likely]]
-            {
-                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-                {
-                    const int x_prev_clamped{std::max(0, x - 1)};
-                    const int x_next_clamped{std::min(plane_width - 1, x + 1)};
-                    const int x_prev2_clamped{std::max(0, x - 2)};
-                    const int x_next2_clamped{std::min(plane_width - 1, x + 2)};
-
-                    dstp[y_fill_s * stride + x] = calculate_mode6_pixel(static_cast<T_Calc>(dstp[y_ref1_s * stride + x_prev_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref1_s * stride + x]), static_cast<T_Calc>(dstp[y_ref1_s * stride + x_next_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev_clamped]), static_cast<T_Calc>(dstp[y_ref2_s * stride + x]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev2_clamped]),
-                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next2_clamped]));
-                }
-            }
-            else
-            {
-                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
-                    dstp[y_fill_s * stride + x] = dstp[y_ref1_s * stride + x];
-            }
-        }
-    }
+    return out_frame;
 }
 
-static AVSValue __cdecl Create_FillBorders(AVSValue args, void* user_data, IScriptEnvironment* env)
+static AVSValue __cdecl Create_FillBorders(AVSValue args, [[maybe_unused]] void* user_data, IScriptEnvironment* env)
 {
     enum ARGS_FB
     {
@@ -1520,7 +861,20 @@ static AVSValue __cdecl Create_FillBorders(AVSValue args, void* user_data, IScri
         Interlaced,
         Ts,
         TsMode,
-        FadeValue
+        FadeValue,
+        Opt,
+        Top2,
+        Bottom2,
+        Threads,
+        BordersFromProps,
+        Autodetect,
+        AutodetectThr,
+        AutodetectWindow,
+        Stats,
+        Regions,
+        Mask,
+        TemporalFrames,
+        TemporalMedian
     };
 
     PClip clip{args[Clip].AsClip()};
@@ -1534,62 +888,63 @@ static AVSValue __cdecl Create_FillBorders(AVSValue args, void* user_data, IScri
     const bool interlaced{args[Interlaced].AsBool(false)};
     const int ts{args[Ts].AsInt(0)};
     const int ts_mode{args[TsMode].AsInt(1)};
-
-    if (mode < 0 || mode > 6)
+    const int opt{args[Opt].AsInt(-1)};
+    const int threads{args[Threads].AsInt(1)};
+    const bool borders_from_props{args[BordersFromProps].AsBool(false)};
+    const bool autodetect{args[Autodetect].AsBool(false)};
+    const float autodetect_thr{args[AutodetectThr].AsFloatf(24.0f)};
+    const int autodetect_window{args[AutodetectWindow].AsInt(50)};
+    // The environment variable enables the instrumentation of every instance without changing the script.
+    const char* stats{args[Stats].AsString(std::getenv("FILLBORDERS_STATS"))};
+    const int temporal_frames{args[TemporalFrames].AsInt(5)};
+    const bool temporal_median{args[TemporalMedian].AsBool(true)};
+
+    if (mode < 0 || mode > 7)
         env->ThrowError("FillBorders: Invalid mode %d specified.", mode);
 
-    PClip child_clip_for_constructor{interlaced ? env->Invoke("SeparateFields", clip).AsClip() : clip};
-
     auto instantiate_filter_helper{[&]<int CONCRETE_MODE_VAL>() -> PClip {
         if (vi.ComponentSize() == 1)
-            return new FillBorders<uint8_t, int, CONCRETE_MODE_VAL>(child_clip_for_constructor, args[Left], args[Top], args[Right],
-                args[Bottom], y_mode, u_mode, v_mode, a_mode, interlaced, ts, ts_mode, args[FadeValue], env);
+            return new FillBorders<uint8_t, int, CONCRETE_MODE_VAL>(clip, args[Left], args[Top], args[Right], args[Bottom], y_mode,
+                u_mode, v_mode, a_mode, interlaced, args[Top2], args[Bottom2], ts, ts_mode, args[FadeValue], opt, threads,
+                borders_from_props, autodetect, autodetect_thr, autodetect_window, stats, args[Regions], args[Mask], temporal_frames,
+                temporal_median, env);
         else if (vi.ComponentSize() == 2)
-            return new FillBorders<uint16_t, int, CONCRETE_MODE_VAL>(child_clip_for_constructor, args[Left], args[Top], args[Right],
-                args[Bottom], y_mode, u_mode, v_mode, a_mode, interlaced, ts, ts_mode, args[FadeValue], env);
+            return new FillBorders<uint16_t, int, CONCRETE_MODE_VAL>(clip, args[Left], args[Top], args[Right], args[Bottom], y_mode,
+                u_mode, v_mode, a_mode, interlaced, args[Top2], args[Bottom2], ts, ts_mode, args[FadeValue], opt, threads,
+                borders_from_props, autodetect, autodetect_thr, autodetect_window, stats, args[Regions], args[Mask], temporal_frames,
+                temporal_median, env);
         else
-            return new FillBorders<float, float, CONCRETE_MODE_VAL>(child_clip_for_constructor, args[Left], args[Top], args[Right],
-                args[Bottom], y_mode, u_mode, v_mode, a_mode, interlaced, ts, ts_mode, args[FadeValue], env);
+            return new FillBorders<float, float, CONCRETE_MODE_VAL>(clip, args[Left], args[Top], args[Right], args[Bottom], y_mode,
+                u_mode, v_mode, a_mode, interlaced, args[Top2], args[Bottom2], ts, ts_mode, args[FadeValue], opt, threads,
+                borders_from_props, autodetect, autodetect_thr, autodetect_window, stats, args[Regions], args[Mask], temporal_frames,
+                temporal_median, env);
     }};
 
-    PClip filter{[&]() {
-        switch (mode)
-        {
-        case 0:
-            return instantiate_filter_helper.operator()<0>();
-        case 1:
-            return instantiate_filter_helper.operator()<1>();
-        case 2:
-            return instantiate_filter_helper.operator()<2>();
-        case 3:
-            return instantiate_filter_helper.operator()<3>();
-        case 4:
-            return instantiate_filter_helper.operator()<4>();
-        case 5:
-            return instantiate_filter_helper.operator()<5>();
-        case 6:
-            return instantiate_filter_helper.operator()<6>();
-        default:
-            return PClip{};
-        }
-    }()};
-
-    if (!filter) [[unlikely]]
+    switch (mode)
     {
-        env->ThrowError("FillBorders: Failed to create filter instance.");
-        return {};
+    case 0:
+        return instantiate_filter_helper.operator()<0>();
+    case 1:
+        return instantiate_filter_helper.operator()<1>();
+    case 2:
+        return instantiate_filter_helper.operator()<2>();
+    case 3:
+        return instantiate_filter_helper.operator()<3>();
+    case 4:
+        return instantiate_filter_helper.operator()<4>();
+    case 5:
+        return instantiate_filter_helper.operator()<5>();
+    case 6:
+        return instantiate_filter_helper.operator()<6>();
+    default:
+        return instantiate_filter_helper.operator()<7>();
     }
-
-    if (interlaced)
-        return env->Invoke("Weave", filter).AsClip();
-    else
-        return filter;
 }
 
 class Arguments
 {
-    AVSValue m_args[9];
-    const char* m_arg_names[9];
+    AVSValue m_args[10];
+    const char* m_arg_names[10];
     int _idx;
 
 public:
@@ -1642,9 +997,12 @@ void margins(const AVSValue& args, Arguments* out_args, int mode = 1)
 
     if (args[mode + 1].Defined())
         out_args->add(args[mode + 6], "v");
+
+    if (args[mode + 7].Defined())
+        out_args->add(args[mode + 7], "opt");
 }
 
-AVSValue __cdecl Create_FillMargins(AVSValue args, void* user_data, IScriptEnvironment* env)
+AVSValue __cdecl Create_FillMargins(AVSValue args, [[maybe_unused]] void* user_data, IScriptEnvironment* env)
 {
     Arguments mapped_args;
 
@@ -1673,7 +1031,20 @@ extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit3(IScri
         "[interlaced]b"
         "[ts]i"
         "[ts_mode]i"
-        "[fade_value]a",
+        "[fade_value]a"
+        "[opt]i"
+        "[top2]i*"
+        "[bottom2]i*"
+        "[threads]i"
+        "[borders_from_props]b"
+        "[autodetect]b"
+        "[autodetect_thr]f"
+        "[autodetect_window]i"
+        "[stats]s"
+        "[regions]a"
+        "[mask]c"
+        "[temporal_frames]i"
+        "[temporal_median]b",
         Create_FillBorders, 0);
 
     env->AddFunction("FillMargins",
@@ -1684,7 +1055,8 @@ extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit3(IScri
         "[bottom]i"
         "[y]i"
         "[u]i"
-        "[v]i",
+        "[v]i"
+        "[opt]i",
         Create_FillMargins, 0);
     return "FillBorders";
 }
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define FB_FORCEINLINE __forceinline
+#else
+#define FB_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+#define FB_RESTRICT __restrict
+
+// Exact unsigned division by a constant (Granlund-Montgomery round-up method), valid for every 32-bit dividend.
+struct lerp_divisor
+{
+    uint32_t multiplier;
+    int shift1;
+    int shift2;
+
+    static lerp_divisor make(const uint32_t divisor) noexcept
+    {
+        int l{0};
+
+        while ((1ULL << l) < divisor)
+            ++l;
+
+        return {static_cast<uint32_t>(((1ULL << 32) * ((1ULL << l) - divisor)) / divisor + 1), std::min(l, 1), std::max(l - 1, 0)};
+    }
+
+    FB_FORCEINLINE uint32_t divide(const uint32_t n) const noexcept
+    {
+        const uint32_t t{static_cast<uint32_t>((static_cast<uint64_t>(n) * multiplier) >> 32)};
+        return (t + ((n - t) >> shift1)) >> shift2;
+    }
+};
+
+// Precomputed linear interpolation (fill * pos + src * (size - pos)) / size for every position of one border side.
+// Integer samples use the exact reciprocal division, float samples keep the division so the result does not change.
+template<typename T_Calc>
+struct lerp_weights
+{
+    std::vector<T_Calc> w_fill; // pos
+    std::vector<T_Calc> w_src;  // size - pos
+    T_Calc size;
+    lerp_divisor divisor;
+    T_Calc min_value;
+    T_Calc max_value;
+
+    FB_FORCEINLINE T_Calc apply(const T_Calc fill, const T_Calc src, const int idx) const noexcept
+    {
+        if constexpr (std::is_integral_v<T_Calc>)
+            return std::min(static_cast<T_Calc>(divisor.divide(static_cast<uint32_t>(fill * w_fill[idx] + src * w_src[idx]))), max_value);
+        else
+            return std::clamp((fill * w_fill[idx] + src * w_src[idx]) / size, min_value, max_value);
+    }
+};
+
+// Intermediate type of the sample type.
+template<typename T_Pixel>
+using calc_t = std::conditional_t<std::is_integral_v<T_Pixel>, int, float>;
+
+// Fades `count` samples of dst towards fill[x] (towards fill_value when fill is null) for mode 5.
+// fade_row uses the weights at idx for every sample, fade_span uses the weights at idx + x for dst[x].
+// fill may be equal to dst but must not partially overlap it.
+template<typename T_Pixel>
+using fade_fn = void (*)(T_Pixel* dst, const T_Pixel* fill, calc_t<T_Pixel> fill_value, int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, int idx) noexcept;
+
+template<typename T_Pixel>
+void fade_row_c(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    for (int x{0}; x < count; ++x)
+        dst[x] = static_cast<T_Pixel>(weights.apply((fill) ? static_cast<calc_t<T_Pixel>>(fill[x]) : fill_value, dst[x], idx));
+}
+
+template<typename T_Pixel>
+void fade_span_c(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    for (int x{0}; x < count; ++x)
+        dst[x] = static_cast<T_Pixel>(weights.apply((fill) ? static_cast<calc_t<T_Pixel>>(fill[x]) : fill_value, dst[x], idx + x));
+}
+
+// Computes one top/bottom border row of mode 0 (fillmargins) from the adjacent row.
+template<typename T_Pixel>
+using fillmargins_row_fn = void (*)(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, int plane_width) noexcept;
+
+template<typename T_Pixel>
+FB_FORCEINLINE T_Pixel fillmargins_pixel(const T_Pixel* FB_RESTRICT prev_row, const int x) noexcept
+{
+    if constexpr (std::is_integral_v<T_Pixel>)
+        return static_cast<T_Pixel>((3 * prev_row[x - 1] + 2 * prev_row[x] + 3 * prev_row[x + 1]) / 8);
+    else
+        return (3 * prev_row[x - 1] + 2 * prev_row[x] + 3 * prev_row[x + 1]) / 8.0f;
+}
+
+// Copies the first pixel and the last (up to) 8 pixels of the row, returns the end of the filtered span [1, end).
+template<typename T_Pixel>
+FB_FORCEINLINE int fillmargins_row_edges(
+    const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, const int plane_width) noexcept
+{
+    if (plane_width <= 0) [[unlikely]]
+        return 0;
+
+    curr_row[0] = prev_row[0];
+
+    if (plane_width == 1) [[unlikely]]
+        return 0;
+
+    const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+    std::memcpy(curr_row + plane_width - num_edge_pixels_to_copy, prev_row + plane_width - num_edge_pixels_to_copy,
+        static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
+
+    return plane_width - num_edge_pixels_to_copy;
+}
+
+template<typename T_Pixel>
+void fillmargins_row_c(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, const int plane_width) noexcept
+{
+    const int end{fillmargins_row_edges(prev_row, curr_row, plane_width)};
+
+    for (int x{1}; x < end; ++x)
+        curr_row[x] = fillmargins_pixel(prev_row, x);
+}
+
+// Left/right border kernels of one row. fill_span sets `count` samples of dst to value (repeat, fillmargins), reverse_span sets
+// dst[x] = src[-x] (mirror, reflect). dst must not overlap the samples read from src.
+template<typename T_Pixel>
+using fill_span_fn = void (*)(T_Pixel* FB_RESTRICT dst, T_Pixel value, int count) noexcept;
+template<typename T_Pixel>
+using reverse_span_fn = void (*)(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, int count) noexcept;
+
+template<typename T_Pixel>
+void fill_span_c(T_Pixel* FB_RESTRICT dst, const T_Pixel value, const int count) noexcept
+{
+    if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+        std::memset(dst, value, count);
+    else
+    {
+        for (int x{0}; x < count; ++x)
+            dst[x] = value;
+    }
+}
+
+template<typename T_Pixel>
+void reverse_span_c(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, const int count) noexcept
+{
+    for (int x{0}; x < count; ++x)
+        dst[x] = src[-x];
+}
+
+template<typename T_Pixel>
+void fillmargins_row_sse41(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, int plane_width) noexcept;
+template<typename T_Pixel>
+void fillmargins_row_avx2(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, int plane_width) noexcept;
+template<typename T_Pixel>
+void fillmargins_row_avx512(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, int plane_width) noexcept;
+
+template<typename T_Pixel>
+void fill_span_sse41(T_Pixel* FB_RESTRICT dst, T_Pixel value, int count) noexcept;
+template<typename T_Pixel>
+void reverse_span_sse41(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, int count) noexcept;
+template<typename T_Pixel>
+void fill_span_avx2(T_Pixel* FB_RESTRICT dst, T_Pixel value, int count) noexcept;
+template<typename T_Pixel>
+void reverse_span_avx2(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, int count) noexcept;
+
+template<typename T_Pixel>
+void fade_row_sse41(T_Pixel* dst, const T_Pixel* fill, calc_t<T_Pixel> fill_value, int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, int idx) noexcept;
+template<typename T_Pixel>
+void fade_span_sse41(T_Pixel* dst, const T_Pixel* fill, calc_t<T_Pixel> fill_value, int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, int idx) noexcept;
+template<typename T_Pixel>
+void fade_row_avx2(T_Pixel* dst, const T_Pixel* fill, calc_t<T_Pixel> fill_value, int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, int idx) noexcept;
+template<typename T_Pixel>
+void fade_span_avx2(T_Pixel* dst, const T_Pixel* fill, calc_t<T_Pixel> fill_value, int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, int idx) noexcept;
+
+// Instruction set levels selectable with `opt`.
+static constexpr int OPT_C{0};
+static constexpr int OPT_SSE41{1};
+static constexpr int OPT_AVX2{2};
+static constexpr int OPT_AVX512{3};
+
+// Kernels resolved once per filter instance for the selected instruction set.
+template<typename T_Pixel>
+struct fillborders_kernels
+{
+    fillmargins_row_fn<T_Pixel> fillmargins_row;
+    fade_fn<T_Pixel> fade_row;
+    fade_fn<T_Pixel> fade_span;
+    fill_span_fn<T_Pixel> fill_span;
+    reverse_span_fn<T_Pixel> reverse_span;
+};
+
+template<typename T_Pixel>
+fillborders_kernels<T_Pixel> select_kernels(const int opt_level) noexcept
+{
+    fillborders_kernels<T_Pixel> kernels{
+        fillmargins_row_c<T_Pixel>, fade_row_c<T_Pixel>, fade_span_c<T_Pixel>, fill_span_c<T_Pixel>, reverse_span_c<T_Pixel>};
+
+    if (opt_level >= OPT_AVX512)
+        kernels.fillmargins_row = fillmargins_row_avx512<T_Pixel>;
+    else if (opt_level == OPT_AVX2)
+        kernels.fillmargins_row = fillmargins_row_avx2<T_Pixel>;
+    else if (opt_level == OPT_SSE41)
+        kernels.fillmargins_row = fillmargins_row_sse41<T_Pixel>;
+
+    // The fade and left/right border kernels have no AVX-512 version.
+    if (opt_level >= OPT_AVX2)
+    {
+        kernels.fade_row = fade_row_avx2<T_Pixel>;
+        kernels.fade_span = fade_span_avx2<T_Pixel>;
+        kernels.fill_span = fill_span_avx2<T_Pixel>;
+        kernels.reverse_span = reverse_span_avx2<T_Pixel>;
+    }
+    else if (opt_level == OPT_SSE41)
+    {
+        kernels.fade_row = fade_row_sse41<T_Pixel>;
+        kernels.fade_span = fade_span_sse41<T_Pixel>;
+        kernels.fill_span = fill_span_sse41<T_Pixel>;
+        kernels.reverse_span = reverse_span_sse41<T_Pixel>;
+    }
+
+    return kernels;
+}
+
+// Worker threads shared by every filter instance of the process, so several instances do not oversubscribe the cores.
+class thread_pool
+{
+    struct job
+    {
+        const std::function<void(int)>* task;
+        int count;
+        int helpers;
+        std::atomic<int> next;
+        std::atomic<int> done;
+    };
+
+    int m_num_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::shared_ptr<job>> m_jobs;
+
+    thread_pool();
+    void worker_loop();
+    static void run_tasks(job& j) noexcept;
+
+public:
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    static thread_pool& instance();
+
+    // Number of threads that can run tasks at the same time, the calling thread included.
+    int max_threads() const noexcept;
+
+    // Calls task(i) for every i in [0, count) on up to `threads` threads and returns when all calls are done.
+    // The calling thread takes part; idle workers take the remaining indices of the queued jobs.
+    void run(int count, int threads, const std::function<void(int)>& task);
+};
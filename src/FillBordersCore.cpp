@@ -0,0 +1,2217 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "FillBordersCore.h"
+
+template<typename T_Pixel, typename T_Calc>
+FB_FORCEINLINE T_Pixel fixborders_pixel(const T_Calc prev_p, const T_Calc cur_p, const T_Calc next_p, const T_Calc ref_prev_p,
+    const T_Calc ref_cur_p, const T_Calc ref_next_p, const T_Calc far_ref_prev_blur_term, const T_Calc far_ref_next_blur_term) noexcept
+{
+    T_Calc fill_prev, fill_cur, fill_next;
+
+    if constexpr (std::is_integral_v<T_Pixel>)
+    {
+        fill_prev = static_cast<T_Calc>(std::llrint(
+            (5.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 1.0 * static_cast<double>(next_p)) / 9.0));
+        fill_cur = static_cast<T_Calc>(std::llrint(
+            (1.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 1.0 * static_cast<double>(next_p)) / 5.0));
+        fill_next = static_cast<T_Calc>(std::llrint(
+            (1.0 * static_cast<double>(prev_p) + 3.0 * static_cast<double>(cur_p) + 5.0 * static_cast<double>(next_p)) / 9.0));
+    }
+    else
+    {
+        fill_prev = (5 * prev_p + 3 * cur_p + next_p) / static_cast<T_Calc>(9.0);
+        fill_cur = (prev_p + 3 * cur_p + next_p) / static_cast<T_Calc>(5.0);
+        fill_next = (prev_p + 3 * cur_p + 5 * next_p) / static_cast<T_Calc>(9.0);
+    }
+
+    const T_Calc blur_prev_val{(2 * ref_prev_p + ref_cur_p + far_ref_prev_blur_term) / static_cast<T_Calc>(4.0)};
+    const T_Calc blur_next_val{(2 * ref_next_p + ref_cur_p + far_ref_next_blur_term) / static_cast<T_Calc>(4.0)};
+
+    const T_Calc diff_next_calc{std::abs(ref_next_p - fill_cur)};
+    const T_Calc diff_prev_calc{std::abs(ref_prev_p - fill_cur)};
+    const T_Calc thr_next_calc{std::abs(ref_next_p - blur_next_val)};
+    const T_Calc thr_prev_calc{std::abs(ref_prev_p - blur_prev_val)};
+
+    if (diff_next_calc > thr_next_calc)
+        return (diff_prev_calc < diff_next_calc) ? static_cast<T_Pixel>(fill_prev) : static_cast<T_Pixel>(fill_next);
+    else if (diff_prev_calc > thr_prev_calc)
+        return static_cast<T_Pixel>(fill_next);
+    else
+        return static_cast<T_Pixel>(fill_cur);
+}
+
+std::array<int, 4> derive_border_array(std::array<int, 4> result_array, const int num_values, const int subsample_shift) noexcept
+{
+    if (num_values == 1)
+    {
+        const int chroma_value{result_array[0] >> subsample_shift};
+        result_array[1] = chroma_value;
+        result_array[2] = chroma_value;
+        result_array[3] = result_array[0];
+    }
+    else if (num_values == 2)
+    {
+        result_array[2] = result_array[1];
+        result_array[3] = result_array[0];
+    }
+    else if (num_values == 3)
+        result_array[3] = result_array[0];
+
+    return result_array;
+}
+
+// printf-like formatting of the error messages.
+static std::string format_error(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char buffer[256];
+    std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    return buffer;
+}
+
+static int64_t elapsed_ns(const std::chrono::steady_clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Appends the element dst <- src to a fill plan, extending the last operation when the element continues it.
+static void add_fill_element(fill_plan& plan, const int dst, const int src)
+{
+    if (!plan.empty() && plan.back().kind != fill_op::blend && plan.back().dst + plan.back().count == dst)
+    {
+        fill_op& last{plan.back()};
+        fill_op::op_kind kind{last.kind};
+
+        if (last.count == 1)
+            kind = (src == last.src) ? fill_op::broadcast : ((src == last.src + 1) ? fill_op::copy : fill_op::reverse);
+
+        // A reverse operation is only extended while its source stays outside of the destination.
+        if ((kind == fill_op::broadcast && src == last.src) || (kind == fill_op::copy && src == last.src + last.count) ||
+            (kind == fill_op::reverse && src == last.src - last.count && (last.src < last.dst || src > dst)))
+        {
+            last.kind = kind;
+            ++last.count;
+            return;
+        }
+    }
+
+    plan.push_back({fill_op::copy, dst, src, 1});
+}
+
+// Left/right border operations of a row plan. N is the number of samples of a fixed size variant: the loop is unrolled and the samples
+// are loaded before they are stored. With N = 0 any size is handled by the kernels of the cpu.
+template<typename T_Pixel, int N>
+static void broadcast_op(
+    [[maybe_unused]] const fillborders_kernels<T_Pixel>& kernels, T_Pixel* FB_RESTRICT row_ptr, const fill_op& op) noexcept
+{
+    if constexpr (N == 0)
+        kernels.fill_span(row_ptr + op.dst, row_ptr[op.src], op.count);
+    else
+    {
+        const T_Pixel value{row_ptr[op.src]};
+        T_Pixel* FB_RESTRICT const dst{row_ptr + op.dst};
+        [&]<size_t... K>(std::index_sequence<K...>) { ((dst[K] = value), ...); }(std::make_index_sequence<N>{});
+    }
+}
+
+template<typename T_Pixel, int N>
+static void copy_op([[maybe_unused]] const fillborders_kernels<T_Pixel>& kernels, T_Pixel* FB_RESTRICT row_ptr, const fill_op& op) noexcept
+{
+    if constexpr (N == 0)
+        std::memmove(row_ptr + op.dst, row_ptr + op.src, static_cast<size_t>(op.count) * sizeof(T_Pixel));
+    else
+    {
+        std::array<T_Pixel, N> samples;
+        std::memcpy(samples.data(), row_ptr + op.src, N * sizeof(T_Pixel));
+        std::memcpy(row_ptr + op.dst, samples.data(), N * sizeof(T_Pixel));
+    }
+}
+
+template<typename T_Pixel>
+static void copy_forward_op(
+    [[maybe_unused]] const fillborders_kernels<T_Pixel>& kernels, T_Pixel* FB_RESTRICT row_ptr, const fill_op& op) noexcept
+{
+    for (int k{0}; k < op.count; ++k)
+        row_ptr[op.dst + k] = row_ptr[op.src + k];
+}
+
+template<typename T_Pixel, int N>
+static void reverse_op(
+    [[maybe_unused]] const fillborders_kernels<T_Pixel>& kernels, T_Pixel* FB_RESTRICT row_ptr, const fill_op& op) noexcept
+{
+    if constexpr (N == 0)
+        kernels.reverse_span(row_ptr + op.dst, row_ptr + op.src, op.count);
+    else
+    {
+        std::array<T_Pixel, N> samples;
+        std::array<T_Pixel, N> reversed;
+        std::memcpy(samples.data(), row_ptr + op.src - (N - 1), N * sizeof(T_Pixel));
+        [&]<size_t... K>(std::index_sequence<K...>) { ((reversed[K] = samples[N - 1 - K]), ...); }(std::make_index_sequence<N>{});
+        std::memcpy(row_ptr + op.dst, reversed.data(), N * sizeof(T_Pixel));
+    }
+}
+
+template<typename T_Pixel>
+static row_op_fn<T_Pixel> select_row_op(const fill_op& op) noexcept
+{
+    // [kind][size: any, 1, 2, 4, 8]
+    static constexpr std::array<std::array<row_op_fn<T_Pixel>, 5>, 4> row_ops{{
+        {broadcast_op<T_Pixel, 0>, broadcast_op<T_Pixel, 1>, broadcast_op<T_Pixel, 2>, broadcast_op<T_Pixel, 4>,
+            broadcast_op<T_Pixel, 8>},
+        {copy_op<T_Pixel, 0>, copy_op<T_Pixel, 1>, copy_op<T_Pixel, 2>, copy_op<T_Pixel, 4>, copy_op<T_Pixel, 8>},
+        {copy_forward_op<T_Pixel>, copy_forward_op<T_Pixel>, copy_forward_op<T_Pixel>, copy_forward_op<T_Pixel>,
+            copy_forward_op<T_Pixel>},
+        {reverse_op<T_Pixel, 0>, reverse_op<T_Pixel, 1>, reverse_op<T_Pixel, 2>, reverse_op<T_Pixel, 4>, reverse_op<T_Pixel, 8>},
+    }};
+    const int size{(op.count == 1) ? 1 : ((op.count == 2) ? 2 : ((op.count == 4) ? 3 : ((op.count == 8) ? 4 : 0)))};
+
+    return row_ops[op.kind][size];
+}
+
+// N is the number of columns of a fixed size variant, 0 for any number.
+template<typename T_Pixel, int N>
+static void gather_columns(T_Pixel* FB_RESTRICT strip, const T_Pixel* FB_RESTRICT srcp, const size_t stride,
+    [[maybe_unused]] const int num_cols, const int height) noexcept
+{
+    for (int y{0}; y < height; ++y)
+    {
+        const T_Pixel* FB_RESTRICT const row_ptr{srcp + static_cast<int64_t>(y) * stride};
+
+        if constexpr (N == 0)
+        {
+            for (int c{0}; c < num_cols; ++c)
+                strip[static_cast<size_t>(c) * height + y] = row_ptr[c];
+        }
+        else
+            [&]<size_t... C>(std::index_sequence<C...>) { ((strip[C * height + y] = row_ptr[C]), ...); }(std::make_index_sequence<N>{});
+    }
+}
+
+template<typename T_Pixel, int N>
+static void scatter_columns(T_Pixel* FB_RESTRICT dstp, const T_Pixel* FB_RESTRICT strip, const size_t stride,
+    [[maybe_unused]] const int num_cols, const int height) noexcept
+{
+    for (int y{0}; y < height; ++y)
+    {
+        T_Pixel* FB_RESTRICT const row_ptr{dstp + static_cast<int64_t>(y) * stride};
+
+        if constexpr (N == 0)
+        {
+            for (int c{0}; c < num_cols; ++c)
+                row_ptr[c] = strip[static_cast<size_t>(c) * height + y];
+        }
+        else
+            [&]<size_t... C>(std::index_sequence<C...>) { ((row_ptr[C] = strip[C * height + y]), ...); }(std::make_index_sequence<N>{});
+    }
+}
+
+// The strip of a border of 1, 2, 4 or 8 columns also holds the two reference columns next to it.
+template<typename T_Pixel>
+static gather_columns_fn<T_Pixel> select_gather_columns(const int num_cols) noexcept
+{
+    switch (num_cols)
+    {
+    case 3:
+        return gather_columns<T_Pixel, 3>;
+    case 4:
+        return gather_columns<T_Pixel, 4>;
+    case 6:
+        return gather_columns<T_Pixel, 6>;
+    case 10:
+        return gather_columns<T_Pixel, 10>;
+    default:
+        return gather_columns<T_Pixel, 0>;
+    }
+}
+
+template<typename T_Pixel>
+static scatter_columns_fn<T_Pixel> select_scatter_columns(const int num_cols) noexcept
+{
+    switch (num_cols)
+    {
+    case 1:
+        return scatter_columns<T_Pixel, 1>;
+    case 2:
+        return scatter_columns<T_Pixel, 2>;
+    case 4:
+        return scatter_columns<T_Pixel, 4>;
+    case 8:
+        return scatter_columns<T_Pixel, 8>;
+    default:
+        return scatter_columns<T_Pixel, 0>;
+    }
+}
+
+void fill_stats_histogram::add(const int64_t frame_ns, const fill_stats& stats) noexcept
+{
+    int bucket{0};
+
+    while (bucket < NUM_BUCKETS - 1 && (frame_ns >> (bucket + 1)) > 0)
+        ++bucket;
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    m_frame_ns.fetch_add(frame_ns, std::memory_order_relaxed);
+
+    for (int i{0}; i < 4; ++i)
+    {
+        m_copy_ns[i].fetch_add(stats.copy_ns[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_fill_ns[i].fetch_add(stats.fill_ns[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_bytes_read[i].fetch_add(stats.bytes_read[i], std::memory_order_relaxed);
+        m_bytes_written[i].fetch_add(stats.bytes_written[i], std::memory_order_relaxed);
+    }
+}
+
+std::string fill_stats_histogram::to_json(const std::string& name, const int num_planes) const
+{
+    const auto number{[](const auto& value) { return std::to_string(value.load(std::memory_order_relaxed)); }};
+
+    std::string json{
+        "{\"filter\":\"" + name + "\",\"frames\":" + number(m_frames) + ",\"frame_ns\":" + number(m_frame_ns) + ",\"planes\":["};
+
+    for (int i{0}; i < num_planes; ++i)
+        json += std::string{(i) ? "," : ""} + "{\"copy_ns\":" + number(m_copy_ns[i]) + ",\"fill_ns\":" + number(m_fill_ns[i]) +
+                ",\"bytes_read\":" + number(m_bytes_read[i]) + ",\"bytes_written\":" + number(m_bytes_written[i]) + "}";
+
+    json += "],\"frame_ns_histogram\":[";
+    bool first{true};
+
+    for (int b{0}; b < NUM_BUCKETS; ++b)
+    {
+        if (const uint64_t count{m_buckets[b].load(std::memory_order_relaxed)})
+        {
+            json += std::string{(first) ? "" : ","} + "{\"min_ns\":" + std::to_string(1ULL << b) + ",\"frames\":" + std::to_string(count) +
+                    "}";
+            first = false;
+        }
+    }
+
+    return json + "]}";
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fillborders_core(const fillborders_format& format, const std::array<int, 4>& process,
+    const bool interlaced, const int ts, const int ts_mode, const std::optional<std::array<T_Calc, 4>>& fade_target_value,
+    const int opt_level, const int threads)
+    : m_format(format),
+      m_process(process),
+      m_interlaced(interlaced),
+      m_ts_runtime(ts),
+      m_ts_mode_runtime(ts_mode),
+      m_fade_target_value(fade_target_value),
+      m_ts_kernel_data([&] {
+          std::array<float, TS_KERNELSIZE> kernel{};
+
+          if (ts > 0 && MODE_VAL == 4 && (ts_mode == 1 || ts_mode == 2))
+          {
+              const float p_gauss{1.2f};
+              float sum{};
+
+              for (int i{0}; i < TS_KERNELSIZE; ++i)
+              {
+                  const int val{i - TS_KERNELSIZE / 2};
+                  kernel[i] = static_cast<float>(std::pow(2.0, -p_gauss * val * val));
+                  sum += kernel[i];
+              }
+
+              if (sum != 0.0f)
+              {
+                  for (int i{0}; i < TS_KERNELSIZE; ++i)
+                      kernel[i] /= sum;
+              }
+              else if (TS_KERNELSIZE > 0)
+                  kernel[TS_KERNELSIZE / 2] = 1.0f;
+          }
+
+          return kernel;
+      }()),
+      m_kernels(select_kernels<T_Pixel>(opt_level)),
+      m_threads(threads)
+{
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+std::string fillborders_core<T_Pixel, T_Calc, MODE_VAL>::check() const
+{
+    if (m_format.num_planes < 1 || m_format.num_planes > 4)
+        return "FillBorders: the number of planes must be between 1..4.";
+
+    const bool valid_bits{(std::is_same_v<T_Pixel, uint8_t>)    ? m_format.bits == 8
+                          : (std::is_same_v<T_Pixel, uint16_t>) ? m_format.bits > 8 && m_format.bits <= 16
+                                                                : m_format.bits == 32};
+
+    if (!valid_bits)
+        return format_error("FillBorders: %d-bit samples are not supported.", m_format.bits);
+
+    if (m_ts_runtime < 0)
+        return "FillBorders: ts must be non-negative.";
+
+    if (m_ts_runtime * 2 > MAX_TSIZE && m_ts_runtime > 0)
+        return format_error("FillBorders: ts*2 cannot exceed MAX_TSIZE (%d).", MAX_TSIZE);
+
+    if (m_ts_mode_runtime < 0 || m_ts_mode_runtime > 2)
+        return "FillBorders: ts_mode must be 0, 1, or 2.";
+
+    if (m_threads < 0)
+        return "FillBorders: threads must be equal to or greater than 0.";
+
+    if (m_interlaced && m_format.height % (2 << m_format.subsample_shift_h))
+        return format_error("FillBorders: height must be mod %d for interlaced=true.", 2 << m_format.subsample_shift_h);
+
+    return {};
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+std::string fillborders_core<T_Pixel, T_Calc, MODE_VAL>::check_geometry(const geometry& g) const
+{
+    // Each field of an interlaced frame is processed as a plane of half height.
+    const int num_fields{(m_interlaced) ? 2 : 1};
+
+    for (int i{}; i < m_format.num_planes; ++i)
+    {
+        if (m_process[i] != 3)
+            continue;
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            const int top{g.top[field][i]};
+            const int bottom{g.bottom[field][i]};
+
+            if (g.left[i] < 0)
+                return "FillBorders: left must be equal to or greater than 0.";
+
+            if (top < 0)
+                return format_error("FillBorders: %s must be equal to or greater than 0.", (field) ? "top2" : "top");
+
+            if (g.right[i] < 0)
+                return "FillBorders: right must be equal to or greater than 0.";
+
+            if (bottom < 0)
+                return format_error("FillBorders: %s must be equal to or greater than 0.", (field) ? "bottom2" : "bottom");
+
+            if (m_ts_runtime > 0 && MODE_VAL == 4)
+            {
+                if (g.left[i] > 0 && m_ts_runtime > g.left[i])
+                    return format_error("FillBorders: ts must be <= left border size for component %d.", i);
+
+                if (top > 0 && m_ts_runtime > top)
+                    return format_error("FillBorders: ts must be <= top border size for component %d.", i);
+
+                if (g.right[i] > 0 && m_ts_runtime > g.right[i])
+                    return format_error("FillBorders: ts must be <= right border size for component %d.", i);
+
+                if (bottom > 0 && m_ts_runtime > bottom)
+                    return format_error("FillBorders: ts must be <= bottom border size for component %d.", i);
+            }
+
+            const int current_plane_w_check{m_format.plane_width(i)};
+            const int current_plane_h_check{m_format.plane_height(i) / num_fields};
+
+            if (MODE_VAL == 0 || MODE_VAL == 1 || MODE_VAL == 5 || MODE_VAL == 6)
+            {
+                if (current_plane_w_check < g.left[i] + g.right[i] || current_plane_h_check < top + bottom)
+                    return format_error("FillBorders: borders are too big for component %d (mode %d).", i, MODE_VAL);
+            }
+            else if (MODE_VAL == 2 || MODE_VAL == 3)
+            {
+                if (g.left[i] > 0 && current_plane_w_check < 2 * g.left[i])
+                    return format_error("FillBorders: clip too small for left border on component %d, mode %d", i, MODE_VAL);
+
+                if (g.right[i] > 0 && current_plane_w_check < 2 * g.right[i])
+                    return format_error("FillBorders: clip too small for right border on component %d, mode %d", i, MODE_VAL);
+
+                if (top > 0 && current_plane_h_check < 2 * top)
+                    return format_error("FillBorders: clip too small for top border on component %d, mode %d", i, MODE_VAL);
+
+                if (bottom > 0 && current_plane_h_check < 2 * bottom)
+                    return format_error("FillBorders: clip too small for bottom border on component %d, mode %d", i, MODE_VAL);
+            }
+            else if (MODE_VAL == 4)
+            {
+                if (current_plane_w_check < g.left[i] + g.right[i] || current_plane_h_check < top + bottom)
+                    return format_error("FillBorders: borders too big for wrap mode on component %d", i);
+            }
+        }
+    }
+
+    return {};
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::finish_geometry(geometry& g) const
+{
+    g.empty = true;
+
+    for (int i{0}; i < m_format.num_planes; ++i)
+    {
+        if (m_process[i] == 3 && (g.left[i] || g.right[i] || g.top[0][i] || g.top[1][i] || g.bottom[0][i] || g.bottom[1][i]))
+            g.empty = false;
+    }
+
+    if constexpr (MODE_VAL <= 4)
+        compile_plans(g);
+
+    if constexpr (MODE_VAL == 6)
+    {
+        for (int i{0}; i < m_format.num_planes; ++i)
+        {
+            const int w{m_format.plane_width(i)};
+            g.gather_columns[i] = {
+                select_gather_columns<T_Pixel>(std::min(g.left[i] + 2, w)), select_gather_columns<T_Pixel>(std::min(g.right[i] + 2, w))};
+            g.scatter_columns[i] = {
+                select_scatter_columns<T_Pixel>(std::min(g.left[i], w)), select_scatter_columns<T_Pixel>(std::min(g.right[i], w))};
+        }
+    }
+
+    if constexpr (MODE_VAL <= 4)
+    {
+        for (int field{0}; field < 2; ++field)
+        {
+            for (int i{0}; i < m_format.num_planes; ++i)
+            {
+                const int w{m_format.plane_width(i)};
+                const int h{m_format.plane_height(i) >> m_interlaced};
+                const int l{g.left[i]};
+                const int t{g.top[field][i]};
+                const int r{g.right[i]};
+                const int b{g.bottom[field][i]};
+
+                // Whether every sample read by the fill lies inside the interior [l, w - r) x [t, h - b).
+                if (l < 0 || t < 0 || r < 0 || b < 0 || l + r >= w || t + b >= h)
+                    continue;
+
+                if constexpr (MODE_VAL == 0 || MODE_VAL == 1)
+                    g.fused_rows[field][i] = true;
+                else if constexpr (MODE_VAL == 2)
+                    g.fused_rows[field][i] = (2 * l + r <= w) && (l + 2 * r <= w) && (2 * t + b <= h) && (t + 2 * b <= h);
+                else if constexpr (MODE_VAL == 3)
+                    g.fused_rows[field][i] =
+                        (!l || 2 * l + r < w) && (!r || l + 2 * r < w) && (!t || 2 * t + b < h) && (!b || t + 2 * b < h);
+                else if constexpr (MODE_VAL == 4)
+                    g.fused_rows[field][i] =
+                        (!l || 2 * l + r <= w) && (!r || l + 2 * r <= w) && (!t || 2 * t + b <= h) && (!b || t + 2 * b <= h);
+            }
+        }
+    }
+
+    const int num_fields{(m_interlaced) ? 2 : 1};
+
+    if constexpr (MODE_VAL == 4 || MODE_VAL == 5)
+    {
+        const int bits{m_format.bits};
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            for (int i{}; i < m_format.num_planes; ++i)
+            {
+                if (m_process[i] != 3)
+                    continue;
+
+                const bool chroma{!m_format.rgb && (i == 1 || i == 2)};
+                const std::array<int, 4> borders{g.left[i], g.top[field][i], g.right[i], g.bottom[field][i]};
+
+                for (int side{}; side < 4; ++side)
+                {
+                    lerp_weights<T_Calc>& w{g.lerp_tables[field][i][side]};
+                    // mode 5 fades over the whole border, mode 4 lerps the ts pixels next to the edge.
+                    const int count{
+                        (MODE_VAL == 5) ? borders[side] : std::min(borders[side], std::min(m_ts_runtime, MAX_TSIZE / 2))};
+                    const int size{(MODE_VAL == 5) ? count : count + 1};
+                    // Weight of the fill value grows towards the outer edge of the frame.
+                    const bool outer_first{side == SIDE_LEFT || side == SIDE_TOP};
+
+                    if (count == 0)
+                        continue;
+
+                    w.w_fill.resize(count);
+                    w.w_src.resize(count);
+
+                    for (int k{}; k < count; ++k)
+                    {
+                        const int pos{(MODE_VAL == 5) ? (outer_first ? count - k : k) : (outer_first ? k + 1 : count - k)};
+                        w.w_fill[k] = static_cast<T_Calc>(pos);
+                        w.w_src[k] = static_cast<T_Calc>(size - pos);
+                    }
+
+                    w.size = static_cast<T_Calc>(size);
+                    w.divisor = lerp_divisor::make(static_cast<uint32_t>(size));
+
+                    if constexpr (std::is_integral_v<T_Pixel>)
+                    {
+                        w.min_value = 0;
+                        w.max_value = static_cast<T_Calc>((1 << bits) - 1);
+                    }
+                    else
+                    {
+                        w.min_value = (chroma) ? -0.5f : 0.0f;
+                        w.max_value = (chroma) ? 0.5f : 1.0f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::compile_plans(geometry& g) const
+{
+    // The elements are added in the order of the fill, a sample or row whose source is out of range is left as it is.
+    const auto add_border{[&](fill_plan& plan, const int pos, const int begin, const int end, const int size) {
+        if (const int src{border_source(pos, begin, end, size)}; src >= 0 && src < size)
+            add_fill_element(plan, pos, src);
+    }};
+
+    for (int i{0}; i < m_format.num_planes; ++i)
+    {
+        const int w{m_format.plane_width(i)};
+        fill_plan plan;
+
+        for (int x{0}; x < g.left[i]; ++x)
+            add_border(plan, x, g.left[i], w - g.right[i], w);
+
+        for (int x{w - g.right[i]}; x < w; ++x)
+            add_border(plan, x, g.left[i], w - g.right[i], w);
+
+        g.row_plans[i].clear();
+
+        for (fill_op& op : plan)
+        {
+            if (op.kind == fill_op::copy && op.src < op.dst && op.src + op.count > op.dst)
+                op.kind = fill_op::copy_forward;
+
+            g.row_plans[i].push_back({select_row_op<T_Pixel>(op), op});
+        }
+    }
+
+    for (int field{0}; field < 2; ++field)
+    {
+        for (int i{0}; i < m_format.num_planes; ++i)
+        {
+            const int h{m_format.plane_height(i) >> m_interlaced};
+            const int t{g.top[field][i]};
+            const int b{g.bottom[field][i]};
+            fill_plan& plan{g.border_plans[field][i]};
+            plan.clear();
+
+            // mode 0 filters each row from the one next to it towards the interior, starting at the edge.
+            if constexpr (MODE_VAL == 0)
+            {
+                for (int y{std::min(t, h - 1) - 1}; y >= 0; --y)
+                    plan.push_back({fill_op::blend, y, y + 1, 1});
+
+                for (int y{std::max(h - b, 1)}; y < h; ++y)
+                    plan.push_back({fill_op::blend, y, y - 1, 1});
+            }
+            else
+            {
+                for (int y{0}; y < t; ++y)
+                    add_border(plan, y, t, h - b, h);
+
+                for (int y{h - b}; y < h; ++y)
+                    add_border(plan, y, t, h - b, h);
+            }
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto fillborders_core<T_Pixel, T_Calc, MODE_VAL>::get_geometry(geometry&& sizes, std::string& error) const
+    -> std::shared_ptr<const geometry>
+{
+    const auto same_borders{[&](const geometry& other) noexcept {
+        return other.left == sizes.left && other.top == sizes.top && other.right == sizes.right && other.bottom == sizes.bottom;
+    }};
+
+    std::lock_guard<std::mutex> lock{m_geometry_cache_mutex};
+
+    for (const std::shared_ptr<const geometry>& cached : m_geometry_cache)
+    {
+        if (same_borders(*cached))
+            return cached;
+    }
+
+    // Only new sizes are validated.
+    error = check_geometry(sizes);
+
+    if (!error.empty())
+        return nullptr;
+
+    finish_geometry(sizes);
+
+    if (m_geometry_cache.size() == GEOMETRY_CACHE_SIZE)
+        m_geometry_cache.erase(m_geometry_cache.begin());
+
+    m_geometry_cache.emplace_back(std::make_shared<const geometry>(std::move(sizes)));
+    return m_geometry_cache.back();
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fill(const geometry& g, const frame_planes& frame, fill_stats* stats) const
+{
+    const int num_fields{(m_interlaced) ? 2 : 1};
+    const int num_threads{(m_threads == 1) ? 1 : ((m_threads) ? m_threads : thread_pool::instance().max_threads())};
+
+    const auto run_tasks{[&](const int count, const std::function<void(int)>& task) {
+        if (num_threads == 1)
+        {
+            for (int t{0}; t < count; ++t)
+                task(t);
+        }
+        else
+        {
+            thread_pool::instance().run(count, num_threads, task);
+        }
+    }};
+
+    struct plane_data
+    {
+        int component_idx;
+        int width;
+        int height; // of one field
+        int src_stride;
+        int dst_stride;
+        const uint8_t* srcp;
+        uint8_t* dstp;
+        bool copy;
+        bool fused;
+    };
+
+    // Rows [y_begin, y_end) of one field of a plane.
+    struct row_band
+    {
+        const plane_data* plane;
+        int field;
+        int y_begin;
+        int y_end;
+    };
+
+    std::array<plane_data, 4> planes;
+    int num_planes{0};
+    std::vector<row_band> bands;
+
+    for (int i{0}; i < m_format.num_planes; ++i)
+    {
+        if (m_process[i] == 1) [[unlikely]]
+            continue;
+
+        // Only the borders are modified, a plane whose source and destination are the same is filled in place.
+        const bool in_place{frame.srcp[i] == frame.dstp[i]};
+        // The copy path builds each destination row in one pass instead of copying the whole plane and then filling it.
+        const bool fused{!in_place && m_process[i] == 3 && g.fused_rows[0][i] && g.fused_rows[1][i]};
+        planes[num_planes] = {i, m_format.plane_width(i) * static_cast<int>(sizeof(T_Pixel)), m_format.plane_height(i) / num_fields,
+            frame.src_stride[i], frame.dst_stride[i], frame.srcp[i], frame.dstp[i], !in_place && !fused, fused};
+        const plane_data& plane{planes[num_planes++]};
+
+        if (stats) [[unlikely]]
+        {
+            const int64_t plane_bytes{static_cast<int64_t>(plane.width) * m_format.plane_height(i)};
+            int64_t interior_bytes{0};
+
+            for (int field{0}; field < num_fields; ++field)
+                interior_bytes += static_cast<int64_t>(std::max(m_format.plane_width(i) - g.left[i] - g.right[i], 0)) *
+                                  std::max(plane.height - g.top[field][i] - g.bottom[field][i], 0) * sizeof(T_Pixel);
+
+            stats->bytes_read[i] = (plane.copy) ? plane_bytes : ((fused) ? interior_bytes : 0);
+            stats->bytes_written[i] = (!in_place) ? plane_bytes : ((m_process[i] == 3) ? plane_bytes - interior_bytes : 0);
+        }
+
+        if (!plane.copy && (m_process[i] == 2 || MODE_VAL > 4))
+            continue;
+
+        // One band per field when running on a single thread, otherwise about two bands per thread.
+        const int band_height{(num_threads == 1) ? plane.height
+                                                 : std::max(MIN_BAND_HEIGHT, (plane.height + num_threads * 2 - 1) / (num_threads * 2))};
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            for (int y{0}; y < plane.height; y += band_height)
+                bands.push_back({&plane, field, y, std::min(y + band_height, plane.height)});
+        }
+    }
+
+    // A field is every other line of the frame, starting at line `field`.
+    // The planes are copied and the left/right borders of the interior rows (modes 0-4) are filled band by band first, the top/bottom
+    // borders need the finished rows next to them and are filled per field afterwards.
+    run_tasks(static_cast<int>(bands.size()), [&](const int t) {
+        const auto start{(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+        const row_band& band{bands[t]};
+        const plane_data& plane{*band.plane};
+        const int i{plane.component_idx};
+        const int src_stride{plane.src_stride * num_fields};
+        const int dst_stride{plane.dst_stride * num_fields};
+        const uint8_t* const srcp{plane.srcp + static_cast<int64_t>(band.field) * plane.src_stride};
+        uint8_t* const dstp{plane.dstp + static_cast<int64_t>(band.field) * plane.dst_stride};
+
+        if (plane.copy)
+        {
+            for (int y{band.y_begin}; y < band.y_end; ++y)
+                std::memcpy(dstp + static_cast<int64_t>(y) * dst_stride, srcp + static_cast<int64_t>(y) * src_stride, plane.width);
+        }
+
+        if constexpr (MODE_VAL <= 4)
+        {
+            if (m_process[i] == 3)
+                fill_rows_impl(g, reinterpret_cast<T_Pixel*>(dstp), (plane.fused) ? reinterpret_cast<const T_Pixel*>(srcp) : nullptr,
+                    static_cast<int>(plane.width / sizeof(T_Pixel)), std::max(band.y_begin, g.top[band.field][i]),
+                    std::min(band.y_end, plane.height - g.bottom[band.field][i]), dst_stride / sizeof(T_Pixel),
+                    src_stride / sizeof(T_Pixel), i);
+        }
+
+        if (stats) [[unlikely]]
+            stats->copy_ns[i].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    });
+
+    // Columns [x_begin, x_end) of the borders of one field of a plane. Only the top/bottom borders of mode 0 are split into stripes,
+    // otherwise a task covers the whole width. A stripe computes its rows in two rows of `scratch`.
+    struct border_task
+    {
+        const plane_data* plane;
+        int field;
+        int x_begin;
+        int x_end;
+        size_t scratch_offset;
+    };
+
+    std::vector<border_task> border_tasks;
+    size_t scratch_size{0};
+
+    for (int p{0}; p < num_planes; ++p)
+    {
+        const int i{planes[p].component_idx};
+
+        if (m_process[i] != 3)
+            continue;
+
+        const int width{static_cast<int>(planes[p].width / sizeof(T_Pixel))};
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            int num_stripes{1};
+
+            if constexpr (MODE_VAL == 0)
+                num_stripes = fillmargins_num_stripes(g, width, planes[p].height, i, field, num_threads);
+
+            for (int stripe{0}; stripe < num_stripes; ++stripe)
+            {
+                const int x_begin{static_cast<int>(static_cast<int64_t>(width) * stripe / num_stripes)};
+                const int x_end{static_cast<int>(static_cast<int64_t>(width) * (stripe + 1) / num_stripes)};
+                border_tasks.push_back({&planes[p], field, x_begin, x_end, scratch_size});
+
+                // The window of a stripe is the stripe, the border rows on each side and up to 8 copied pixels, at most the row.
+                if (num_stripes > 1)
+                    scratch_size += static_cast<size_t>(std::min(width, x_end - x_begin + 2 * planes[p].height + 8)) * 2;
+            }
+        }
+    }
+
+    std::vector<T_Pixel> scratch(scratch_size);
+
+    run_tasks(static_cast<int>(border_tasks.size()), [&](const int t) {
+        const auto start{(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+        const border_task& task{border_tasks[t]};
+        const plane_data& plane{*task.plane};
+        const int i{plane.component_idx};
+        const int field{task.field};
+        const int width_processing{static_cast<int>(plane.width / sizeof(T_Pixel))};
+        const int height_processing{plane.height};
+        const int stride_processing{static_cast<int>(plane.dst_stride / sizeof(T_Pixel)) * num_fields};
+        T_Pixel* FB_RESTRICT const dstp_processing{
+            reinterpret_cast<T_Pixel*>(plane.dstp + static_cast<int64_t>(field) * plane.dst_stride)};
+
+        if (MODE_VAL == 0 && task.x_end - task.x_begin < width_processing)
+            fillmargins_stripe_impl(g, dstp_processing, width_processing, height_processing, stride_processing, i, field, task.x_begin,
+                task.x_end, scratch.data() + task.scratch_offset);
+        else if constexpr (MODE_VAL <= 4)
+            run_border_plan(g.border_plans[field][i], dstp_processing, width_processing, stride_processing);
+        else if constexpr (MODE_VAL == 5)
+            handle_mode_5_fade_impl(g, dstp_processing, width_processing, height_processing, stride_processing, i, field);
+        else if constexpr (MODE_VAL == 6)
+            handle_mode_6_fixborders_impl(g, dstp_processing, width_processing, height_processing, stride_processing, i, field);
+
+        if constexpr (MODE_VAL == 4)
+        {
+            if (m_ts_runtime > 0) [[likely]]
+            {
+                T_Pixel temp_buf_for_gaussian[MAX_TSIZE];
+                apply_mode4_transient_smoothing_impl(
+                    g, dstp_processing, width_processing, height_processing, stride_processing, i, field, temp_buf_for_gaussian);
+            }
+        }
+
+        if (stats) [[unlikely]]
+            stats->fill_ns[i].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    });
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+std::string fillborders_core<T_Pixel, T_Calc, MODE_VAL>::check_packed() const
+{
+    if constexpr (MODE_VAL == 6)
+        return "FillBorders: mode 6 is not supported for packed formats.";
+
+    if (MODE_VAL == 4 && m_ts_runtime > 0)
+        return "FillBorders: ts is not supported for packed formats.";
+
+    return {};
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fill_packed(const geometry& g, const packed_layout& layout, const uint8_t* srcp,
+    const int src_stride, uint8_t* dstp, const int dst_stride, fill_stats* stats) const noexcept
+{
+    const int num_fields{(m_interlaced) ? 2 : 1};
+    auto start{(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+
+    if (srcp != dstp)
+    {
+        const size_t row_size{static_cast<size_t>(m_format.width) * layout.samples_per_pixel * sizeof(T_Pixel)};
+
+        for (int y{0}; y < m_format.height; ++y)
+            std::memcpy(dstp + static_cast<int64_t>(y) * dst_stride, srcp + static_cast<int64_t>(y) * src_stride, row_size);
+
+        if (stats) [[unlikely]]
+        {
+            stats->copy_ns[0].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+            stats->bytes_read[0] = stats->bytes_written[0] = static_cast<int64_t>(row_size) * m_format.height;
+        }
+    }
+
+    const int stride{dst_stride / static_cast<int>(sizeof(T_Pixel))};
+
+    for (int field{0}; field < num_fields; ++field)
+    {
+        for (int i{0}; i < m_format.num_planes; ++i)
+        {
+            if (m_process[i] != 3)
+                continue;
+
+            const int width{m_format.plane_width(i)};
+            const int height{m_format.plane_height(i) / num_fields};
+
+            if (stats) [[unlikely]]
+            {
+                start = std::chrono::steady_clock::now();
+
+                // In place only the borders are stored.
+                if (srcp == dstp)
+                {
+                    const int64_t interior{static_cast<int64_t>(std::max(width - g.left[i] - g.right[i], 0)) *
+                                           std::max(height - g.top[field][i] - g.bottom[field][i], 0)};
+                    stats->bytes_written[i] += (static_cast<int64_t>(width) * height - interior) * static_cast<int64_t>(sizeof(T_Pixel));
+                }
+            }
+
+            T_Pixel* const base{reinterpret_cast<T_Pixel*>(dstp) + static_cast<int64_t>(field) * stride + layout.offset[i]};
+            packed_component_impl(g, base, layout.step[i], width, height, stride * num_fields, i, field);
+
+            if (stats) [[unlikely]]
+                stats->fill_ns[i].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::packed_component_impl(const geometry& g, T_Pixel* FB_RESTRICT base, const int step,
+    const int width, const int height, const int stride, const int component_idx, const int field) const noexcept
+{
+    // Same rules as the planar implementations, applied to the samples of one component: x is the pixel of the component in the row.
+    const auto at{[&](const int y, const int x) noexcept -> T_Pixel& {
+        return base[static_cast<int64_t>(y) * stride + static_cast<int64_t>(x) * step];
+    }};
+    const auto copy_row{[&](const int dst_y, const int src_y) noexcept {
+        for (int x{0}; x < width; ++x)
+            at(dst_y, x) = at(src_y, x);
+    }};
+
+    const int l{g.left[component_idx]};
+    const int t{g.top[field][component_idx]};
+    const int r{g.right[component_idx]};
+    const int b{g.bottom[field][component_idx]};
+
+    if (width <= 0 || height <= 0) [[unlikely]]
+        return;
+
+    if constexpr (MODE_VAL <= 4)
+    {
+        const auto fill_sample{[&](const int y, const int x) noexcept {
+            if (const int src_x{border_source(x, l, width - r, width)}; src_x >= 0 && src_x < width) [[likely]]
+                at(y, x) = at(y, src_x);
+        }};
+        const auto fill_row{[&](const int y) noexcept {
+            if (const int src_y{border_source(y, t, height - b, height)}; src_y >= 0 && src_y < height) [[likely]]
+            {
+                for (int x{0}; x < width; ++x)
+                    at(y, x) = at(src_y, x);
+            }
+        }};
+
+        for (int y{t}; y < height - b; ++y)
+        {
+            for (int x{0}; x < l; ++x)
+                fill_sample(y, x);
+
+            for (int x{width - r}; x < width; ++x)
+                fill_sample(y, x);
+        }
+
+        if constexpr (MODE_VAL == 0)
+        {
+            const auto fillmargins_row{[&](const int dst_y, const int src_y) noexcept {
+                const int num_edge_pixels{std::min(8, width - 1)};
+                at(dst_y, 0) = at(src_y, 0);
+
+                for (int x{1}; x < width - num_edge_pixels; ++x)
+                {
+                    if constexpr (std::is_integral_v<T_Pixel>)
+                        at(dst_y, x) = static_cast<T_Pixel>((3 * at(src_y, x - 1) + 2 * at(src_y, x) + 3 * at(src_y, x + 1)) / 8);
+                    else
+                        at(dst_y, x) = (3 * at(src_y, x - 1) + 2 * at(src_y, x) + 3 * at(src_y, x + 1)) / 8.0f;
+                }
+
+                for (int x{std::max(width - num_edge_pixels, 1)}; x < width; ++x)
+                    at(dst_y, x) = at(src_y, x);
+            }};
+
+            for (int y{std::min(t, height - 1) - 1}; y >= 0; --y)
+                fillmargins_row(y, y + 1);
+
+            for (int y{std::max(height - b, 1)}; y < height; ++y)
+                fillmargins_row(y, y - 1);
+        }
+        else
+        {
+            for (int y{0}; y < t; ++y)
+                fill_row(y);
+
+            for (int y{height - b}; y < height; ++y)
+                fill_row(y);
+        }
+    }
+    else if constexpr (MODE_VAL == 5)
+    {
+        const std::array<lerp_weights<T_Calc>, 4>& weights{g.lerp_tables[field][component_idx]};
+        // Every border fades towards row 0 unless fade_value is set.
+        const auto target{[&](const int x) noexcept -> T_Calc {
+            return (m_fade_target_value) ? (*m_fade_target_value)[component_idx] : static_cast<T_Calc>(at(0, x));
+        }};
+        const auto fade{[&](const int y, const int x, const lerp_weights<T_Calc>& w, const int idx) noexcept {
+            at(y, x) = static_cast<T_Pixel>(w.apply(target(x), at(y, x), idx));
+        }};
+
+        for (int y{0}; y < t; ++y)
+        {
+            for (int x{0}; x < width; ++x)
+                fade(y, x, weights[SIDE_TOP], y);
+        }
+
+        for (int y{height - b}; y < height; ++y)
+        {
+            for (int x{0}; x < width; ++x)
+                fade(y, x, weights[SIDE_BOTTOM], y - (height - b));
+        }
+
+        for (int y{0}; y < height; ++y)
+        {
+            for (int x{0}; x < l; ++x)
+                fade(y, x, weights[SIDE_LEFT], x);
+        }
+
+        // The target of the right border is row 0 from x = 0, like in the planar implementation.
+        for (int y{0}; y < height; ++y)
+        {
+            for (int x{0}; x < r; ++x)
+                at(y, width - r + x) = static_cast<T_Pixel>(weights[SIDE_RIGHT].apply(target(x), at(y, width - r + x), x));
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+std::string fillborders_core<T_Pixel, T_Calc, MODE_VAL>::check_mask() const
+{
+    if constexpr (MODE_VAL > 3)
+        return "FillBorders: mask supports only modes 0..3.";
+
+    return {};
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fill_masked(const mask_spans& spans, const frame_planes& frame, fill_stats* stats) const
+    noexcept
+{
+    // The rows of a field repeat the rows of the same field.
+    const int row_step{(m_interlaced) ? 2 : 1};
+
+    for (int i{0}; i < m_format.num_planes; ++i)
+    {
+        if (m_process[i] != 3 || spans[i].empty())
+            continue;
+
+        const auto start{(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+        const int width{m_format.plane_width(i)};
+        const int height{m_format.plane_height(i)};
+        const int stride{frame.dst_stride[i] / static_cast<int>(sizeof(T_Pixel))};
+        T_Pixel* FB_RESTRICT const dstp{reinterpret_cast<T_Pixel*>(frame.dstp[i])};
+        const auto row_ptr{[&](const int y) noexcept { return dstp + static_cast<int64_t>(y) * stride; }};
+        // Fully masked rows, filled after the other runs from the nearest row of the field that is not.
+        std::vector<int> masked_rows;
+        int64_t masked_samples{0};
+
+        for (const mask_span& span : spans[i])
+        {
+            T_Pixel* FB_RESTRICT const row{row_ptr(span.y)};
+            const int count{span.x_end - span.x_begin};
+            masked_samples += count;
+
+            if (!span.clean_before && !span.clean_after)
+            {
+                masked_rows.push_back(span.y);
+                continue;
+            }
+
+            // The first half of the run is filled from the samples before it, the second half from the samples after it.
+            const int num_before{(!span.clean_after) ? count : ((!span.clean_before) ? 0 : (count + 1) / 2)};
+
+            for (int k{0}; k < num_before; ++k)
+            {
+                int src_k{0};
+
+                if constexpr (MODE_VAL == 2)
+                    src_k = std::min(k, span.clean_before - 1);
+                else if constexpr (MODE_VAL == 3)
+                    src_k = std::min(k + 1, span.clean_before - 1);
+
+                row[span.x_begin + k] = row[span.x_begin - 1 - src_k];
+            }
+
+            for (int k{0}; k < count - num_before; ++k)
+            {
+                int src_k{0};
+
+                if constexpr (MODE_VAL == 2)
+                    src_k = std::min(k, span.clean_after - 1);
+                else if constexpr (MODE_VAL == 3)
+                    src_k = std::min(k + 1, span.clean_after - 1);
+
+                row[span.x_end - 1 - k] = row[span.x_end + src_k];
+            }
+        }
+
+        const auto fully_masked{[&](const int y) noexcept { return std::binary_search(masked_rows.begin(), masked_rows.end(), y); }};
+
+        // The source rows are not fully masked, the rows can be filled in any order. A field whose rows are all masked is left as is.
+        for (const int y : masked_rows)
+        {
+            int above{y - row_step};
+            int below{y + row_step};
+
+            while (above >= 0 && fully_masked(above))
+                above -= row_step;
+
+            while (below < height && fully_masked(below))
+                below += row_step;
+
+            const int src_y{(below >= height || (above >= 0 && y - above <= below - y)) ? above : below};
+
+            if (src_y >= 0)
+                std::memcpy(row_ptr(y), row_ptr(src_y), static_cast<size_t>(width) * sizeof(T_Pixel));
+        }
+
+        if (stats) [[unlikely]]
+        {
+            stats->fill_ns[i].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+            stats->bytes_written[i] += masked_samples * static_cast<int64_t>(sizeof(T_Pixel));
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+auto fillborders_core<T_Pixel, T_Calc, MODE_VAL>::edge_strips(const geometry& g) const -> std::vector<edge_strip>
+{
+    const int num_fields{(m_interlaced) ? 2 : 1};
+    std::vector<edge_strip> strips;
+    size_t offset{0};
+
+    for (int i{0}; i < m_format.num_planes; ++i)
+    {
+        if (m_process[i] != 3)
+            continue;
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            const int interior_width{m_format.plane_width(i) - g.left[i] - g.right[i]};
+            const int interior_height{m_format.plane_height(i) / num_fields - g.top[field][i] - g.bottom[field][i]};
+
+            // Without interior the borders keep the values of the current frame.
+            if (interior_width <= 0 || interior_height <= 0)
+                continue;
+
+            const std::array<int, 4> sizes{g.left[i], g.top[field][i], g.right[i], g.bottom[field][i]};
+
+            for (int side{SIDE_LEFT}; side <= SIDE_BOTTOM; ++side)
+            {
+                if (!sizes[side])
+                    continue;
+
+                const int count{(side == SIDE_LEFT || side == SIDE_RIGHT) ? interior_height : interior_width};
+                strips.push_back({i, field, side, offset, count});
+                offset += count;
+            }
+        }
+    }
+
+    return strips;
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+size_t fillborders_core<T_Pixel, T_Calc, MODE_VAL>::edge_samples(const geometry& g) const
+{
+    const std::vector<edge_strip> strips{edge_strips(g)};
+    return (strips.empty()) ? 0 : strips.back().offset + strips.back().count;
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::extract_edges(const geometry& g, const frame_planes& frame, T_Pixel* FB_RESTRICT edges)
+    const
+{
+    const int num_fields{(m_interlaced) ? 2 : 1};
+
+    for (const edge_strip& strip : edge_strips(g))
+    {
+        const int i{strip.component_idx};
+        const int stride{frame.src_stride[i] / static_cast<int>(sizeof(T_Pixel)) * num_fields};
+        const T_Pixel* FB_RESTRICT const srcp{
+            reinterpret_cast<const T_Pixel*>(frame.srcp[i] + static_cast<int64_t>(strip.field) * frame.src_stride[i])};
+        const int height{m_format.plane_height(i) / num_fields};
+        T_Pixel* FB_RESTRICT const dst{edges + strip.offset};
+
+        if (strip.side == SIDE_TOP || strip.side == SIDE_BOTTOM)
+        {
+            const int y{(strip.side == SIDE_TOP) ? g.top[strip.field][i] : height - g.bottom[strip.field][i] - 1};
+            std::memcpy(dst, srcp + static_cast<int64_t>(y) * stride + g.left[i], static_cast<size_t>(strip.count) * sizeof(T_Pixel));
+        }
+        else
+        {
+            const int x{(strip.side == SIDE_LEFT) ? g.left[i] : m_format.plane_width(i) - g.right[i] - 1};
+
+            for (int k{0}; k < strip.count; ++k)
+                dst[k] = srcp[static_cast<int64_t>(g.top[strip.field][i] + k) * stride + x];
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fill_temporal(const geometry& g, const frame_planes& frame,
+    const std::vector<const T_Pixel*>& edges, const bool median, fill_stats* stats) const
+{
+    const int num_fields{(m_interlaced) ? 2 : 1};
+    const int num_frames{static_cast<int>(edges.size())};
+    std::vector<T_Pixel> values(num_frames);
+    std::vector<T_Pixel> filtered;
+
+    for (const edge_strip& strip : edge_strips(g))
+    {
+        const auto start{(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+        const int i{strip.component_idx};
+        filtered.resize(strip.count);
+
+        for (int k{0}; k < strip.count; ++k)
+        {
+            if (median)
+            {
+                for (int f{0}; f < num_frames; ++f)
+                    values[f] = edges[f][strip.offset + k];
+
+                std::nth_element(values.begin(), values.begin() + num_frames / 2, values.end());
+                filtered[k] = values[num_frames / 2];
+            }
+            else
+            {
+                T_Calc sum{0};
+
+                for (int f{0}; f < num_frames; ++f)
+                    sum += edges[f][strip.offset + k];
+
+                if constexpr (std::is_integral_v<T_Calc>)
+                    filtered[k] = static_cast<T_Pixel>((sum + num_frames / 2) / num_frames);
+                else
+                    filtered[k] = static_cast<T_Pixel>(sum / num_frames);
+            }
+        }
+
+        const int width{m_format.plane_width(i)};
+        const int height{m_format.plane_height(i) / num_fields};
+        const int stride{frame.dst_stride[i] / static_cast<int>(sizeof(T_Pixel)) * num_fields};
+        T_Pixel* FB_RESTRICT const dstp{
+            reinterpret_cast<T_Pixel*>(frame.dstp[i] + static_cast<int64_t>(strip.field) * frame.dst_stride[i])};
+        const int top{g.top[strip.field][i]};
+        const int bottom{g.bottom[strip.field][i]};
+        const int left{g.left[i]};
+        const int right{g.right[i]};
+
+        if (strip.side == SIDE_LEFT || strip.side == SIDE_RIGHT)
+        {
+            const int x{(strip.side == SIDE_LEFT) ? 0 : width - right};
+            const int size{(strip.side == SIDE_LEFT) ? left : right};
+
+            for (int k{0}; k < strip.count; ++k)
+                m_kernels.fill_span(dstp + static_cast<int64_t>(top + k) * stride + x, filtered[k], size);
+        }
+        else
+        {
+            const int y_begin{(strip.side == SIDE_TOP) ? 0 : height - bottom};
+            const int y_end{(strip.side == SIDE_TOP) ? top : height};
+
+            for (int y{y_begin}; y < y_end; ++y)
+            {
+                T_Pixel* FB_RESTRICT const row{dstp + static_cast<int64_t>(y) * stride};
+                std::memcpy(row + left, filtered.data(), static_cast<size_t>(strip.count) * sizeof(T_Pixel));
+
+                if (left > 0)
+                    m_kernels.fill_span(row, filtered.front(), left);
+
+                if (right > 0)
+                    m_kernels.fill_span(row + width - right, filtered.back(), right);
+            }
+        }
+
+        if (stats) [[unlikely]]
+            stats->fill_ns[i].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+int fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::fillmargins_num_stripes(const geometry& g, const int plane_width,
+    const int plane_height, const int component_idx, const int field, const int num_threads) const noexcept
+{
+    // The top rows are [0, top_edge) and are computed from row top_edge, the bottom rows (bottom_edge, plane_height) from row
+    // bottom_edge. The stripes need edge rows that are not written in this pass.
+    const int top_edge{std::min(g.top[field][component_idx], plane_height - 1)};
+    const int bottom_edge{std::max(plane_height - g.bottom[field][component_idx], 1) - 1};
+    const int num_rows{std::max(top_edge, plane_height - 1 - bottom_edge)};
+
+    if (num_threads == 1 || num_rows < MIN_STRIPE_ROWS || top_edge > bottom_edge)
+        return 1;
+
+    return std::clamp(plane_width / std::max(MIN_STRIPE_WIDTH, num_rows * MIN_STRIPE_ROWS_FACTOR), 1, num_threads * 2);
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::fillmargins_stripe_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp,
+    const int plane_width, const int plane_height, const size_t stride, const int component_idx, const int field, const int x_begin,
+    const int x_end, T_Pixel* FB_RESTRICT scratch) const noexcept
+{
+    // Border row k (counted from the edge row) only depends on the edge row within k samples, so the columns [x_begin, x_end) are
+    // computed from a copy of the edge row widened by the number of rows, independently of the other stripes. The result is the same
+    // as filling the whole rows one after another.
+    const int num_edge_pixels{std::min(8, plane_width - 1)};
+
+    const auto fill_rows{[&](const int edge_y, const int num_rows, const int direction) {
+        if (num_rows <= 0)
+            return;
+
+        const int lo{std::max(x_begin - num_rows, 0)};
+        // A window that reaches the copied last pixels of the row is extended to the end of the row.
+        const int hi{(x_end + num_rows > plane_width - num_edge_pixels) ? plane_width : x_end + num_rows};
+        const int window_width{hi - lo};
+        T_Pixel* prev_row{scratch};
+        T_Pixel* curr_row{scratch + window_width};
+        std::memcpy(prev_row, dstp + stride * static_cast<int64_t>(edge_y) + lo, static_cast<size_t>(window_width) * sizeof(T_Pixel));
+
+        for (int k{1}; k <= num_rows; ++k)
+        {
+            m_kernels.fillmargins_row(prev_row, curr_row, window_width);
+
+            // The kernel copies the last pixels of the window, inside the row they are filtered like the other pixels.
+            if (hi < plane_width)
+            {
+                for (int x{window_width - std::min(8, window_width - 1)}; x < window_width - 1; ++x)
+                    curr_row[x] = fillmargins_pixel(prev_row, x);
+            }
+
+            std::memcpy(dstp + stride * static_cast<int64_t>(edge_y + direction * k) + x_begin, curr_row + x_begin - lo,
+                static_cast<size_t>(x_end - x_begin) * sizeof(T_Pixel));
+            std::swap(prev_row, curr_row);
+        }
+    }};
+
+    const int top_edge{std::min(g.top[field][component_idx], plane_height - 1)};
+    const int bottom_edge{std::max(plane_height - g.bottom[field][component_idx], 1) - 1};
+
+    fill_rows(top_edge, top_edge, -1);
+    fill_rows(bottom_edge, plane_height - 1 - bottom_edge, 1);
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::run_row_plan(
+    const std::vector<row_op<T_Pixel>>& plan, T_Pixel* FB_RESTRICT row_ptr) const noexcept
+{
+    for (const row_op<T_Pixel>& op : plan)
+        op.run(m_kernels, row_ptr, op.op);
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::run_border_plan(const fill_plan& plan, T_Pixel* FB_RESTRICT dstp,
+    const int plane_width, const size_t stride) const noexcept
+{
+    const auto row{[&](const int y) noexcept { return dstp + stride * static_cast<int64_t>(y); }};
+    const size_t row_bytes{static_cast<size_t>(plane_width) * sizeof(T_Pixel)};
+
+    for (const fill_op& op : plan)
+    {
+        if (op.kind == fill_op::blend)
+        {
+            m_kernels.fillmargins_row(row(op.src), row(op.dst), plane_width);
+            continue;
+        }
+
+        // The rows are copied one after another, a row written before can be the source of a later one.
+        const int src_step{(op.kind == fill_op::broadcast) ? 0 : ((op.kind == fill_op::reverse) ? -1 : 1)};
+
+        for (int k{0}; k < op.count; ++k)
+        {
+            if (const int src_y{op.src + src_step * k}; src_y != op.dst + k)
+                std::memcpy(row(op.dst + k), row(src_y), row_bytes);
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL>::fill_rows_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp,
+    const T_Pixel* FB_RESTRICT srcp, const int plane_width, const int y_begin, const int y_end, const size_t dst_stride,
+    const size_t src_stride, const int component_idx) const noexcept
+{
+    // Fills the left/right borders of the interior rows [y_begin, y_end), the rows only read themselves.
+    // With srcp the interior of each row is copied from the source first. Only valid when g.fused_rows[component_idx] is set: every
+    // source sample of the fill lies in the interior, so the border rows and columns of the source are never read and each destination
+    // row is written exactly once.
+    const int interior_x{g.left[component_idx]};
+    const size_t interior_bytes{static_cast<size_t>(plane_width - g.left[component_idx] - g.right[component_idx]) * sizeof(T_Pixel)};
+
+    for (int y{y_begin}; y < y_end; ++y)
+    {
+        T_Pixel* FB_RESTRICT const dst_row_ptr{dstp + static_cast<int64_t>(y) * dst_stride};
+
+        if (srcp)
+            std::memcpy(dst_row_ptr + interior_x, srcp + static_cast<int64_t>(y) * src_stride + interior_x, interior_bytes);
+
+        run_row_plan(g.row_plans[component_idx], dst_row_ptr);
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::apply_mode4_transient_smoothing_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp,
+    const int plane_width, const int plane_height, const size_t stride, const int component_idx, const int field,
+    T_Pixel* FB_RESTRICT temp_buf) const noexcept
+{
+    const int tr_s{std::min(m_ts_runtime, MAX_TSIZE / 2)};
+
+    if (tr_s == 0) [[unlikely]]
+        return;
+
+    const std::array<lerp_weights<T_Calc>, 4>& weights{g.lerp_tables[field][component_idx]};
+
+    if (g.left[component_idx] > 0 && tr_s <= g.left[component_idx]) [[likely]]
+    {
+        for (int y{0}; y < plane_height; ++y)
+        {
+            T_Pixel* FB_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
+
+            switch (m_ts_mode_runtime)
+            {
+            case 0: // Lerp Gradient
+                smooth_lerp_left_impl(current_row_ptr, g.left[component_idx], tr_s, weights[SIDE_LEFT]);
+                break;
+            case 1: // Gaussian Blur - No Original Pixel Change
+                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, g.left[component_idx], tr_s, true, temp_buf, false);
+                break;
+            case 2: // Gaussian Blur - Original Pixels Changed
+                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, g.left[component_idx], tr_s, true, temp_buf, true);
+                break;
+            }
+        }
+    }
+
+    if (g.right[component_idx] > 0 && tr_s <= g.right[component_idx]) [[likely]]
+    {
+        for (int y{0}; y < plane_height; ++y)
+        {
+            T_Pixel* FB_RESTRICT const current_row_ptr{dstp + static_cast<int64_t>(y) * stride};
+
+            switch (m_ts_mode_runtime)
+            {
+            case 0:
+                smooth_lerp_right_impl(current_row_ptr, plane_width, g.right[component_idx], tr_s, weights[SIDE_RIGHT]);
+                break;
+            case 1:
+                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, g.right[component_idx], tr_s, false, temp_buf, false);
+                break;
+            case 2:
+                smooth_gaussian_horizontal_impl(current_row_ptr, plane_width, g.right[component_idx], tr_s, false, temp_buf, true);
+                break;
+            }
+        }
+    }
+
+    const bool smooth_top{g.top[field][component_idx] > 0 && tr_s <= g.top[field][component_idx]};
+    const bool smooth_bottom{g.bottom[field][component_idx] > 0 && tr_s <= g.bottom[field][component_idx]};
+
+    // The top/bottom borders are smoothed a whole row at a time; the gaussian output rows are collected first.
+    std::vector<T_Pixel> temp_rows;
+
+    if (m_ts_mode_runtime != 0 && (smooth_top || smooth_bottom))
+        temp_rows.resize(static_cast<size_t>(tr_s) * 2 * plane_width);
+
+    if (smooth_top) [[likely]]
+    {
+        switch (m_ts_mode_runtime)
+        {
+        case 0:
+            smooth_lerp_top_impl(dstp, plane_width, stride, g.top[field][component_idx], tr_s, weights[SIDE_TOP]);
+            break;
+        case 1:
+            smooth_gaussian_vertical_impl(
+                dstp, plane_width, plane_height, stride, g.top[field][component_idx], tr_s, true, temp_rows.data(), false);
+            break;
+        case 2:
+            smooth_gaussian_vertical_impl(
+                dstp, plane_width, plane_height, stride, g.top[field][component_idx], tr_s, true, temp_rows.data(), true);
+            break;
+        }
+    }
+
+    if (smooth_bottom) [[likely]]
+    {
+        switch (m_ts_mode_runtime)
+        {
+        case 0:
+            smooth_lerp_bottom_impl(dstp, plane_width, plane_height, stride, g.bottom[field][component_idx], tr_s, weights[SIDE_BOTTOM]);
+            break;
+        case 1:
+            smooth_gaussian_vertical_impl(
+                dstp, plane_width, plane_height, stride, g.bottom[field][component_idx], tr_s, false, temp_rows.data(), false);
+            break;
+        case 2:
+            smooth_gaussian_vertical_impl(
+                dstp, plane_width, plane_height, stride, g.bottom[field][component_idx], tr_s, false, temp_rows.data(), true);
+            break;
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_left_impl(T_Pixel* FB_RESTRICT row_ptr, const int border_size,
+    const int tr_s, const lerp_weights<T_Calc>& weights) const noexcept
+{
+    if (border_size == 0 || tr_s == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size{std::min(border_size, tr_s)};
+
+    if (actual_tr_size == 0) [[unlikely]]
+        return;
+
+    const T_Calc original_edge_val{static_cast<T_Calc>(row_ptr[border_size])};
+    const int anchor_x{border_size - actual_tr_size - 1};
+    const T_Calc anchor_val{(anchor_x < 0) ? static_cast<T_Calc>(row_ptr[0]) : static_cast<T_Calc>(row_ptr[anchor_x])};
+
+    for (int k{0}; k < actual_tr_size; ++k)
+    {
+        const int x_to_change{border_size - actual_tr_size + k};
+        row_ptr[x_to_change] = static_cast<T_Pixel>(weights.apply(original_edge_val, anchor_val, k));
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_right_impl(T_Pixel* FB_RESTRICT row_ptr, const int plane_width,
+    const int border_size, const int tr_s, const lerp_weights<T_Calc>& weights) const noexcept
+{
+    if (border_size == 0 || tr_s == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size{std::min(border_size, tr_s)};
+
+    if (actual_tr_size == 0) [[unlikely]]
+        return;
+
+    const T_Calc original_edge_val{static_cast<T_Calc>(row_ptr[plane_width - border_size - 1])};
+    const int anchor_x{plane_width - border_size + actual_tr_size};
+    const T_Calc anchor_val{
+        (anchor_x >= plane_width) ? static_cast<T_Calc>(row_ptr[plane_width - 1]) : static_cast<T_Calc>(row_ptr[anchor_x])};
+
+    for (int k{0}; k < actual_tr_size; ++k)
+    {
+        const int x_to_change{plane_width - border_size + k};
+        row_ptr[x_to_change] = static_cast<T_Pixel>(weights.apply(original_edge_val, anchor_val, k));
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_top_impl(T_Pixel* FB_RESTRICT dstp, const int plane_width,
+    const size_t stride, const int border_size, const int tr_s, const lerp_weights<T_Calc>& weights) const noexcept
+{
+    if (border_size == 0 || tr_s == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size{std::min(border_size, tr_s)};
+
+    if (actual_tr_size == 0) [[unlikely]]
+        return;
+
+    const T_Pixel* const edge_row{dstp + static_cast<int64_t>(border_size) * stride};
+    const int anchor_y{border_size - actual_tr_size - 1};
+    const T_Pixel* const anchor_row{dstp + static_cast<int64_t>(std::max(anchor_y, 0)) * stride};
+
+    // The anchor can be row 0, which is also the row of k = 0, so that row is written last.
+    for (int k{actual_tr_size - 1}; k >= 0; --k)
+    {
+        T_Pixel* FB_RESTRICT const row{dstp + static_cast<int64_t>(border_size - actual_tr_size + k) * stride};
+
+        for (int x{0}; x < plane_width; ++x)
+            row[x] = static_cast<T_Pixel>(weights.apply(static_cast<T_Calc>(edge_row[x]), static_cast<T_Calc>(anchor_row[x]), k));
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_lerp_bottom_impl(T_Pixel* FB_RESTRICT dstp, const int plane_width,
+    const int plane_height, const size_t stride, const int border_size, const int tr_s, const lerp_weights<T_Calc>& weights) const noexcept
+{
+    if (border_size == 0 || tr_s == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size{std::min(border_size, tr_s)};
+
+    if (actual_tr_size == 0) [[unlikely]]
+        return;
+
+    const T_Pixel* const edge_row{dstp + static_cast<int64_t>(plane_height - border_size - 1) * stride};
+    const int anchor_y{plane_height - border_size + actual_tr_size};
+    const T_Pixel* const anchor_row{dstp + static_cast<int64_t>(std::min(anchor_y, plane_height - 1)) * stride};
+
+    // The anchor can be the last row, which is also the row of the last k, so that row is written last.
+    for (int k{0}; k < actual_tr_size; ++k)
+    {
+        T_Pixel* FB_RESTRICT const row{dstp + static_cast<int64_t>(plane_height - border_size + k) * stride};
+
+        for (int x{0}; x < plane_width; ++x)
+            row[x] = static_cast<T_Pixel>(weights.apply(static_cast<T_Calc>(edge_row[x]), static_cast<T_Calc>(anchor_row[x]), k));
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_gaussian_horizontal_impl(T_Pixel* FB_RESTRICT row_ptr,
+    const int plane_width, const int border_size, const int tr_s, const bool is_left_border, T_Pixel* FB_RESTRICT temp_buf,
+    const bool modify_original_pixels) const noexcept
+{
+    if (border_size == 0 || tr_s == 0 || plane_width == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size_for_op{std::min(border_size, tr_s)};
+
+    if (actual_tr_size_for_op == 0) [[unlikely]]
+        return;
+
+    const int conv_window_full_width{actual_tr_size_for_op * 2};
+
+    if (conv_window_full_width > MAX_TSIZE) [[unlikely]]
+        return;
+
+    const int conv_window_start_x_in_row{
+        (is_left_border) ? (border_size - actual_tr_size_for_op) : (plane_width - border_size - actual_tr_size_for_op)};
+
+    for (int xp{0}; xp < conv_window_full_width; ++xp)
+    {
+        const int current_center_x_in_row{conv_window_start_x_in_row + xp};
+        T_Calc sum{0};
+
+        for (int k_idx{0}; k_idx < TS_KERNELSIZE; ++k_idx)
+        {
+            const int sample_x{current_center_x_in_row + k_idx - (TS_KERNELSIZE / 2)};
+            T_Pixel sample_val{[&]() {
+                if (sample_x < 0) [[unlikely]]
+                    return row_ptr[0];
+                else if (sample_x >= plane_width) [[unlikely]]
+                    return row_ptr[plane_width - 1];
+                else [[likely]]
+                    return row_ptr[sample_x];
+            }()};
+
+            sum += static_cast<T_Calc>(sample_val) * m_ts_kernel_data[k_idx];
+        }
+
+        if constexpr (std::is_integral_v<T_Pixel>)
+            temp_buf[xp] = static_cast<T_Pixel>(sum);
+        else
+            temp_buf[xp] = sum;
+    }
+
+    int write_start_x_in_row_final;
+    int temp_buf_read_offset_final;
+    int num_pixels_to_write_final;
+
+    if (modify_original_pixels)
+    {
+        write_start_x_in_row_final = conv_window_start_x_in_row;
+        temp_buf_read_offset_final = 0;
+        num_pixels_to_write_final = conv_window_full_width;
+    }
+    else
+    {
+        if (is_left_border)
+        {
+            write_start_x_in_row_final = border_size - actual_tr_size_for_op;
+            temp_buf_read_offset_final = 0;
+        }
+        else
+        {
+            write_start_x_in_row_final = plane_width - border_size;
+            temp_buf_read_offset_final = actual_tr_size_for_op;
+        }
+
+        num_pixels_to_write_final = actual_tr_size_for_op;
+    }
+
+    for (int k{0}; k < num_pixels_to_write_final; ++k)
+    {
+        const int x_to_change{write_start_x_in_row_final + k};
+
+        if (x_to_change >= 0 && x_to_change < plane_width) [[likely]]
+            row_ptr[x_to_change] = temp_buf[temp_buf_read_offset_final + k];
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::smooth_gaussian_vertical_impl(T_Pixel* FB_RESTRICT dstp, const int plane_width,
+    const int plane_height, const size_t stride, const int border_size, const int tr_s, const bool is_top_border,
+    T_Pixel* FB_RESTRICT temp_rows, const bool modify_original_pixels) const noexcept
+{
+    if (border_size == 0 || tr_s == 0 || plane_height == 0) [[unlikely]]
+        return;
+
+    const int actual_tr_size_for_op{std::min(border_size, tr_s)};
+
+    if (actual_tr_size_for_op == 0) [[unlikely]]
+        return;
+
+    const int conv_window_full_width{actual_tr_size_for_op * 2};
+
+    if (conv_window_full_width > MAX_TSIZE) [[unlikely]]
+        return;
+
+    const int conv_window_start_y_in_col{
+        (is_top_border) ? (border_size - actual_tr_size_for_op) : (plane_height - border_size - actual_tr_size_for_op)};
+
+    // Every output row of the window is computed from the unmodified rows before any of them is written back.
+    for (int yp{0}; yp < conv_window_full_width; ++yp)
+    {
+        std::array<const T_Pixel*, TS_KERNELSIZE> taps;
+
+        for (int k_idx{0}; k_idx < TS_KERNELSIZE; ++k_idx)
+        {
+            const int sample_y{std::clamp(conv_window_start_y_in_col + yp + k_idx - (TS_KERNELSIZE / 2), 0, plane_height - 1)};
+            taps[k_idx] = dstp + static_cast<int64_t>(sample_y) * stride;
+        }
+
+        T_Pixel* FB_RESTRICT const out_row{temp_rows + static_cast<int64_t>(yp) * plane_width};
+
+        for (int x{0}; x < plane_width; ++x)
+        {
+            T_Calc sum{0};
+
+            for (int k_idx{0}; k_idx < TS_KERNELSIZE; ++k_idx)
+                sum += static_cast<T_Calc>(taps[k_idx][x]) * m_ts_kernel_data[k_idx];
+
+            out_row[x] = static_cast<T_Pixel>(sum);
+        }
+    }
+
+    int write_start_y_in_col_final;
+    int temp_buf_read_offset_final;
+    int num_pixels_to_write_final;
+
+    if (modify_original_pixels)
+    {
+        write_start_y_in_col_final = conv_window_start_y_in_col;
+        temp_buf_read_offset_final = 0;
+        num_pixels_to_write_final = conv_window_full_width;
+    }
+    else
+    {
+        if (is_top_border)
+        {
+            write_start_y_in_col_final = border_size - actual_tr_size_for_op;
+            temp_buf_read_offset_final = 0;
+        }
+        else
+        {
+            write_start_y_in_col_final = plane_height - border_size;
+            temp_buf_read_offset_final = actual_tr_size_for_op;
+        }
+
+        num_pixels_to_write_final = actual_tr_size_for_op;
+    }
+
+    for (int k{0}; k < num_pixels_to_write_final; ++k)
+    {
+        const int y_to_change{write_start_y_in_col_final + k};
+
+        if (y_to_change >= 0 && y_to_change < plane_height) [[likely]]
+            std::memcpy(dstp + static_cast<int64_t>(y_to_change) * stride,
+                temp_rows + static_cast<int64_t>(temp_buf_read_offset_final + k) * plane_width, plane_width * sizeof(T_Pixel));
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_5_fade_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp,
+    const int plane_width, const int plane_height, const size_t stride, const int component_idx, const int field) const noexcept
+{
+    if (plane_width == 0 || plane_height == 0) [[unlikely]]
+        return;
+
+    const std::array<lerp_weights<T_Calc>, 4>& weights{g.lerp_tables[field][component_idx]};
+    const int current_m_top{g.top[field][component_idx]};
+    const int current_m_bottom{g.bottom[field][component_idx]};
+    const int current_m_left{g.left[component_idx]};
+    const int current_m_right{g.right[component_idx]};
+
+    const bool use_constant_target = m_fade_target_value.has_value();
+    const T_Calc constant_target_value_for_this_component{
+        use_constant_target ? (*m_fade_target_value)[component_idx] : static_cast<T_Calc>(0)};
+    // Every border fades towards row 0 unless fade_value is set. Row 0 is processed first in each loop.
+    const T_Pixel* const target_row{(use_constant_target) ? nullptr : dstp};
+
+    if (current_m_top > 0) [[likely]]
+    {
+        for (int y_fill{0}; y_fill < current_m_top; ++y_fill)
+            m_kernels.fade_row(dstp + static_cast<int64_t>(y_fill) * stride, target_row, constant_target_value_for_this_component,
+                plane_width, weights[SIDE_TOP], y_fill);
+    }
+
+    if (current_m_bottom > 0) [[likely]]
+    {
+        const int start_bottom_fill_y{plane_height - current_m_bottom};
+
+        for (int y_fill{start_bottom_fill_y}; y_fill < plane_height; ++y_fill)
+            m_kernels.fade_row(dstp + static_cast<int64_t>(y_fill) * stride, target_row, constant_target_value_for_this_component,
+                plane_width, weights[SIDE_BOTTOM], y_fill - start_bottom_fill_y);
+    }
+
+    if (current_m_left > 0) [[likely]]
+    {
+        for (int y_row{0}; y_row < plane_height; ++y_row)
+            m_kernels.fade_span(dstp + static_cast<int64_t>(y_row) * stride, target_row, constant_target_value_for_this_component,
+                current_m_left, weights[SIDE_LEFT], 0);
+    }
+
+    if (current_m_right > 0) [[likely]]
+    {
+        const int start_right_fill_x{plane_width - current_m_right};
+
+        for (int y_row{0}; y_row < plane_height; ++y_row)
+        {
+            // The right border of row 0 can overlap its own target (the first right pixels of row 0), keep the sequential order.
+            const fade_fn<T_Pixel> fade_span{
+                (y_row == 0 && target_row && start_right_fill_x < current_m_right) ? fade_span_c<T_Pixel> : m_kernels.fade_span};
+            fade_span(dstp + static_cast<int64_t>(y_row) * stride + start_right_fill_x, target_row,
+                constant_target_value_for_this_component, current_m_right, weights[SIDE_RIGHT], 0);
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::handle_mode_6_fixborders_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp,
+    const int plane_width, const int plane_height, const size_t stride, const int component_idx, const int field) const noexcept
+{
+    if (plane_width == 0 || plane_height == 0) [[unlikely]]
+        return;
+
+    const int current_m_left{g.left[component_idx]};
+    const int current_m_top{g.top[field][component_idx]};
+    const int current_m_right{g.right[component_idx]};
+    const int current_m_bottom{g.bottom[field][component_idx]};
+
+    // These define how many rows/cols near the main edges are simply copied before complex averaging
+    const int top_copy_zone_height{current_m_top + 3};
+    const int bottom_copy_zone_height{current_m_bottom + 3};
+
+    // --- Left/Right Side Processing ---
+    // The columns are processed transposed: the strip of border and reference columns is gathered into contiguous lines, filled
+    // line by line and scattered back, instead of walking every column down the full plane height.
+    std::vector<T_Pixel> strip;
+
+    auto gather_strip{[&](const int side, const int first_col, const int num_cols) {
+        strip.resize(static_cast<size_t>(num_cols) * plane_height);
+        g.gather_columns[component_idx][side](strip.data(), dstp + first_col, stride, num_cols, plane_height);
+    }};
+
+    auto scatter_strip{[&](const int side, const int first_col, const int strip_offset, const int num_cols) {
+        g.scatter_columns[component_idx][side](
+            dstp + first_col, strip.data() + static_cast<size_t>(strip_offset) * plane_height, stride, num_cols, plane_height);
+    }};
+
+    auto strip_line{[&](const int strip_col) { return strip.data() + static_cast<size_t>(strip_col) * plane_height; }};
+
+    if (current_m_left > 0) [[likely]]
+    {
+        const int strip_cols{std::min(current_m_left + 2, plane_width)};
+        gather_strip(0, 0, strip_cols);
+
+        for (int x_fill{current_m_left - 1}; x_fill >= 0; --x_fill)
+        {
+            const int x_ref1{x_fill + 1};
+            const int x_ref2{x_fill + 2};
+
+            if (x_ref1 >= plane_width) [[unlikely]]
+                continue;
+
+            fixborders_line_impl(strip_line(x_fill), strip_line(x_ref1), (x_ref2 < plane_width) ? strip_line(x_ref2) : nullptr,
+                plane_height, top_copy_zone_height, bottom_copy_zone_height);
+        }
+
+        scatter_strip(0, 0, 0, std::min(current_m_left, plane_width));
+    }
+
+    if (current_m_right > 0) [[likely]]
+    {
+        const int strip_start{std::max(plane_width - current_m_right - 2, 0)};
+        gather_strip(1, strip_start, plane_width - strip_start);
+
+        for (int x_fill{plane_width - current_m_right}; x_fill < plane_width; ++x_fill)
+        {
+            const int x_ref1{x_fill - 1};
+            const int x_ref2{x_fill - 2};
+
+            if (x_ref1 < 0) [[unlikely]]
+                continue;
+
+            fixborders_line_impl(strip_line(x_fill - strip_start), strip_line(x_ref1 - strip_start),
+                (x_ref2 >= 0) ? strip_line(x_ref2 - strip_start) : nullptr, plane_height, top_copy_zone_height, bottom_copy_zone_height);
+        }
+
+        const int first_fill_col{std::max(plane_width - current_m_right, 0)};
+        scatter_strip(1, first_fill_col, first_fill_col - strip_start, plane_width - first_fill_col);
+    }
+
+    // --- Top Side Processing ---
+    if (current_m_top > 0) [[likely]]
+    {
+        for (int y_fill{current_m_top - 1}; y_fill >= 0; --y_fill)
+        {
+            const int64_t y_fill_s{static_cast<int64_t>(y_fill)};
+            const int64_t y_ref1_s{static_cast<int64_t>(y_fill + 1)}; // y+1 row
+            const int64_t y_ref2_s{static_cast<int64_t>(y_fill + 2)}; // y+2 row
+
+            if (y_ref1_s >= plane_height) [[unlikely]]
+                continue;
+
+            // 1. Direct copy for left and right edge zones of this row
+            if (plane_width > 0)
+                dstp[y_fill_s * stride + 0] = dstp[y_ref1_s * stride + 0];
+
+            if (plane_width > 1)
+            { // Last 8 pixels (or fewer)
+                const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+
+                if (num_edge_pixels_to_copy > 0)
+                    std::memcpy(dstp + y_fill_s * stride + plane_width - num_edge_pixels_to_copy,
+                        dstp + y_ref1_s * stride + plane_width - num_edge_pixels_to_copy,
+                        static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
+            }
+
+            // 2. Weighted average for the middle part of this row
+            if (y_ref2_s < plane_height) [[likely]]
+            { // Ensure y+2 is valid
+                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
+                {
+                    // Clamp x-references for edge cases instead of skipping
+                    const int x_prev_clamped{std::max(0, x - 1)};
+                    const int x_next_clamped{std::min(plane_width - 1, x + 1)};
+                    const int x_prev2_clamped{std::max(0, x - 2)};
+                    const int x_next2_clamped{std::min(plane_width - 1, x + 2)};
+
+                    dstp[y_fill_s * stride + x] =
+                        fixborders_pixel<T_Pixel, T_Calc>(static_cast<T_Calc>(dstp[y_ref1_s * stride + x_prev_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref1_s * stride + x]), static_cast<T_Calc>(dstp[y_ref1_s * stride + x_next_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev_clamped]), static_cast<T_Calc>(dstp[y_ref2_s * stride + x]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev2_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next2_clamped]));
+                }
+            }
+            else
+            { // y_ref2 is out of bounds, just copy for the middle part too
+                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
+                    dstp[y_fill_s * stride + x] = dstp[y_ref1_s * stride + x];
+            }
+        }
+    }
+
+    // --- Bottom Side Processing ---
+    if (current_m_bottom > 0) [[likely]]
+    {
+        for (int y_fill{plane_height - current_m_bottom}; y_fill < plane_height; ++y_fill)
+        {
+            const int64_t y_fill_s{static_cast<int64_t>(y_fill)};
+            const int64_t y_ref1_s{static_cast<int64_t>(y_fill - 1)}; // y-1 row
+            const int64_t y_ref2_s{static_cast<int64_t>(y_fill - 2)}; // y-2 row
+
+            if (y_ref1_s < 0) [[unlikely]]
+                continue;
+
+            if (plane_width > 0)
+                dstp[y_fill_s * stride + 0] = dstp[y_ref1_s * stride + 0];
+
+            if (plane_width > 1)
+            {
+                const int num_edge_pixels_to_copy{std::min(8, plane_width - 1)};
+
+                if (num_edge_pixels_to_copy > 0)
+                    std::memcpy(dstp + y_fill_s * stride + plane_width - num_edge_pixels_to_copy,
+                        dstp + y_ref1_s * stride + plane_width - num_edge_pixels_to_copy,
+                        static_cast<size_t>(num_edge_pixels_to_copy) * sizeof(T_Pixel));
+            }
+
+            if (y_ref2_s >= 0) [[likely]]
+            {
+                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
+                {
+                    const int x_prev_clamped{std::max(0, x - 1)};
+                    const int x_next_clamped{std::min(plane_width - 1, x + 1)};
+                    const int x_prev2_clamped{std::max(0, x - 2)};
+                    const int x_next2_clamped{std::min(plane_width - 1, x + 2)};
+
+                    dstp[y_fill_s * stride + x] =
+                        fixborders_pixel<T_Pixel, T_Calc>(static_cast<T_Calc>(dstp[y_ref1_s * stride + x_prev_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref1_s * stride + x]), static_cast<T_Calc>(dstp[y_ref1_s * stride + x_next_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev_clamped]), static_cast<T_Calc>(dstp[y_ref2_s * stride + x]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_prev2_clamped]),
+                        static_cast<T_Calc>(dstp[y_ref2_s * stride + x_next2_clamped]));
+                }
+            }
+            else
+            {
+                for (int x{1}; x < plane_width - std::min(8, plane_width > 0 ? plane_width - 1 : 0); ++x)
+                    dstp[y_fill_s * stride + x] = dstp[y_ref1_s * stride + x];
+            }
+        }
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL_ignored>
+void fillborders_core<T_Pixel, T_Calc, MODE_VAL_ignored>::fixborders_line_impl(T_Pixel* FB_RESTRICT fill_line,
+    const T_Pixel* FB_RESTRICT ref1_line, const T_Pixel* FB_RESTRICT ref2_line, const int line_length, const int head_copy_size,
+    const int tail_copy_size) const noexcept
+{
+    // 1. Direct copy for the edge zones at both ends of the line
+    for (int y{0}; y < std::min(head_copy_size, line_length); ++y)
+        fill_line[y] = ref1_line[y];
+
+    for (int y{std::max(line_length - tail_copy_size, 0)}; y < line_length; ++y)
+        fill_line[y] = ref1_line[y];
+
+    // 2. Weighted average for the middle part (head_copy_size >= 3, so y - 2 and y + 2 are always inside the line)
+    if (ref2_line) [[likely]]
+    {
+        for (int y{head_copy_size}; y < line_length - tail_copy_size; ++y)
+            fill_line[y] = fixborders_pixel<T_Pixel, T_Calc>(static_cast<T_Calc>(ref1_line[y - 1]), static_cast<T_Calc>(ref1_line[y]),
+                static_cast<T_Calc>(ref1_line[y + 1]), static_cast<T_Calc>(ref2_line[y - 1]), static_cast<T_Calc>(ref2_line[y]),
+                static_cast<T_Calc>(ref2_line[y + 1]), static_cast<T_Calc>(ref2_line[y - 2]), static_cast<T_Calc>(ref2_line[y + 2]));
+    }
+    else
+    {
+        for (int y{head_copy_size}; y < line_length - tail_copy_size; ++y)
+            fill_line[y] = ref1_line[y];
+    }
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+class fillborders_region_impl final : public fillborders_region<T_Pixel, T_Calc>
+{
+    using core_t = fillborders_core<T_Pixel, T_Calc, MODE_VAL>;
+
+    const fillborders_format m_format;
+    // Offset of the rectangle in samples of each plane.
+    const std::array<int, 4> m_x;
+    const std::array<int, 4> m_y;
+    const core_t m_core;
+    std::shared_ptr<const typename core_t::geometry> m_geometry;
+
+public:
+    fillborders_region_impl(const fillborders_format& format, const fill_region_params& region, const std::array<int, 4>& process,
+        const bool interlaced, const int ts, const int ts_mode, const std::optional<std::array<T_Calc, 4>>& fade_target_value,
+        const int opt_level, const int threads, std::string& error)
+        : m_format(format),
+          m_x({region.x, region.x >> format.subsample_shift_w, region.x >> format.subsample_shift_w, region.x}),
+          m_y({region.y, region.y >> format.subsample_shift_h, region.y >> format.subsample_shift_h, region.y}),
+          m_core({region.width, region.height, format.num_planes, format.bits, format.subsample_shift_w, format.subsample_shift_h,
+                     format.rgb},
+              process, interlaced, ts, ts_mode, fade_target_value, opt_level, threads)
+    {
+        error = m_core.check();
+
+        if (!error.empty())
+            return;
+
+        m_geometry = m_core.get_geometry({region.left, {region.top, region.top}, region.right, {region.bottom, region.bottom}}, error);
+    }
+
+    void fill(const frame_planes& frame, fill_stats* stats) const override
+    {
+        // The rectangle is filled in place: its source is the destination frame.
+        frame_planes rect{};
+
+        for (int i{0}; i < m_format.num_planes; ++i)
+        {
+            if (!frame.dstp[i])
+                continue;
+
+            uint8_t* const dstp{frame.dstp[i] + static_cast<int64_t>(m_y[i]) * frame.dst_stride[i] + m_x[i] * sizeof(T_Pixel)};
+            rect.srcp[i] = dstp;
+            rect.src_stride[i] = frame.dst_stride[i];
+            rect.dstp[i] = dstp;
+            rect.dst_stride[i] = frame.dst_stride[i];
+        }
+
+        if (!stats) [[likely]]
+        {
+            m_core.fill(*m_geometry, rect);
+            return;
+        }
+
+        // fill sets the byte counts of the planes, they are added to the ones of the frame.
+        fill_stats rect_stats{};
+        m_core.fill(*m_geometry, rect, &rect_stats);
+
+        for (int i{0}; i < m_format.num_planes; ++i)
+        {
+            stats->copy_ns[i].fetch_add(rect_stats.copy_ns[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            stats->fill_ns[i].fetch_add(rect_stats.fill_ns[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            stats->bytes_read[i] += rect_stats.bytes_read[i];
+            stats->bytes_written[i] += rect_stats.bytes_written[i];
+        }
+    }
+};
+
+template<typename T_Pixel, typename T_Calc>
+auto fillborders_region<T_Pixel, T_Calc>::create(const fillborders_format& format, const fill_region_params& region,
+    const std::array<int, 4>& process, const bool interlaced, const int ts, const int ts_mode,
+    const std::optional<std::array<T_Calc, 4>>& fade_target_value, const int opt_level, const int threads, std::string& error)
+    -> std::unique_ptr<const fillborders_region>
+{
+    if (region.x < 0 || region.y < 0 || region.width < 1 || region.height < 1 || region.x > format.width - region.width ||
+        region.y > format.height - region.height)
+    {
+        error = "FillBorders: a region must be a non-empty rectangle inside the frame.";
+        return nullptr;
+    }
+
+    // The rectangle covers whole samples of the subsampled planes, and whole lines of both fields with interlaced=true.
+    const int mod_w{1 << format.subsample_shift_w};
+    const int mod_h{((interlaced) ? 2 : 1) << format.subsample_shift_h};
+
+    if (region.x % mod_w || region.width % mod_w)
+    {
+        error = format_error("FillBorders: the x and width of a region must be mod %d.", mod_w);
+        return nullptr;
+    }
+
+    if (region.y % mod_h || region.height % mod_h)
+    {
+        error = format_error("FillBorders: the y and height of a region must be mod %d.", mod_h);
+        return nullptr;
+    }
+
+    const auto create_impl{[&]<int MODE_VAL>() -> std::unique_ptr<const fillborders_region> {
+        auto impl{std::make_unique<fillborders_region_impl<T_Pixel, T_Calc, MODE_VAL>>(
+            format, region, process, interlaced, ts, ts_mode, fade_target_value, opt_level, threads, error)};
+
+        if (!error.empty())
+            return nullptr;
+
+        return impl;
+    }};
+
+    switch (region.mode)
+    {
+    case 0:
+        return create_impl.template operator()<0>();
+    case 1:
+        return create_impl.template operator()<1>();
+    case 2:
+        return create_impl.template operator()<2>();
+    case 3:
+        return create_impl.template operator()<3>();
+    case 4:
+        return create_impl.template operator()<4>();
+    case 5:
+        return create_impl.template operator()<5>();
+    case 6:
+        return create_impl.template operator()<6>();
+    default:
+        error = "FillBorders: the mode of a region must be between 0..6.";
+        return nullptr;
+    }
+}
+
+int cpu_opt_level() noexcept
+{
+#if defined(_MSC_VER)
+    std::array<int, 4> regs{};
+    __cpuid(regs.data(), 0);
+    const int max_leaf{regs[0]};
+
+    __cpuid(regs.data(), 1);
+    const bool has_sse41{!!(regs[2] & (1 << 19))};
+    // OSXSAVE and the OS saves the YMM (and ZMM) registers.
+    const bool has_osxsave{!!(regs[2] & (1 << 27))};
+    const unsigned long long xcr0{(has_osxsave) ? _xgetbv(0) : 0};
+    bool has_avx2{}, has_avx512{};
+
+    if (max_leaf >= 7 && (xcr0 & 0x6) == 0x6)
+    {
+        __cpuidex(regs.data(), 7, 0);
+        has_avx2 = !!(regs[1] & (1 << 5)) && !!(regs[1] & (1 << 3));
+        has_avx512 = (xcr0 & 0xe6) == 0xe6 && !!(regs[1] & (1 << 16)) && !!(regs[1] & (1 << 30));
+    }
+#else
+    __builtin_cpu_init();
+    const bool has_sse41{!!__builtin_cpu_supports("sse4.1")};
+    const bool has_avx2{!!__builtin_cpu_supports("avx2")};
+    const bool has_avx512{__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")};
+#endif
+
+    return (has_avx512) ? OPT_AVX512 : (has_avx2) ? OPT_AVX2 : (has_sse41) ? OPT_SSE41 : OPT_C;
+}
+
+#define FB_INSTANTIATE(T_Pixel, T_Calc) \
+    template class fillborders_core<T_Pixel, T_Calc, 0>; \
+    template class fillborders_core<T_Pixel, T_Calc, 1>; \
+    template class fillborders_core<T_Pixel, T_Calc, 2>; \
+    template class fillborders_core<T_Pixel, T_Calc, 3>; \
+    template class fillborders_core<T_Pixel, T_Calc, 4>; \
+    template class fillborders_core<T_Pixel, T_Calc, 5>; \
+    template class fillborders_core<T_Pixel, T_Calc, 6>; \
+    template class fillborders_region<T_Pixel, T_Calc>;
+
+FB_INSTANTIATE(uint8_t, int)
+FB_INSTANTIATE(uint16_t, int)
+FB_INSTANTIATE(float, float)
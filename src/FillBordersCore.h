@@ -0,0 +1,459 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FillBorders.h"
+
+static constexpr int TS_KERNELSIZE{5};
+static constexpr int MAX_TSIZE{10};
+// Number of border sizes given at run time (frame properties, detection) that are kept validated.
+static constexpr size_t GEOMETRY_CACHE_SIZE{16};
+// Smallest band of rows of a plane that is given to one thread.
+static constexpr int MIN_BAND_HEIGHT{32};
+// The top/bottom borders of mode 0 with at least this many rows are split into stripes of columns when running on several threads.
+// A stripe is at least MIN_STRIPE_WIDTH and MIN_STRIPE_ROWS_FACTOR times the border rows wide, it recomputes that many columns.
+static constexpr int MIN_STRIPE_ROWS{8};
+static constexpr int MIN_STRIPE_WIDTH{256};
+static constexpr int MIN_STRIPE_ROWS_FACTOR{8};
+
+// Largest number of frames of the temporal fill (mode 7 of the AviSynth filter).
+static constexpr int MAX_TEMPORAL_FRAMES{64};
+
+// Border sides, index of lerp_weights tables.
+static constexpr int SIDE_LEFT{0};
+static constexpr int SIDE_TOP{1};
+static constexpr int SIDE_RIGHT{2};
+static constexpr int SIDE_BOTTOM{3};
+
+// Format of the frames. Planes 1 and 2 are subsampled unless the format is RGB.
+struct fillborders_format
+{
+    int width;
+    int height;
+    int num_planes;
+    int bits;
+    int subsample_shift_w;
+    int subsample_shift_h;
+    bool rgb;
+
+    int plane_width(const int plane) const noexcept
+    {
+        return (plane == 1 || plane == 2) ? (width >> subsample_shift_w) : width;
+    }
+
+    int plane_height(const int plane) const noexcept
+    {
+        return (plane == 1 || plane == 2) ? (height >> subsample_shift_h) : height;
+    }
+};
+
+// Planes of one frame, strides in bytes. A plane whose source and destination are the same is filled in place.
+struct frame_planes
+{
+    std::array<const uint8_t*, 4> srcp;
+    std::array<int, 4> src_stride;
+    std::array<uint8_t*, 4> dstp;
+    std::array<int, 4> dst_stride;
+};
+
+// Interleaved components of a packed frame: sample x of component i of a row is at offset[i] + x * step[i], in samples.
+struct packed_layout
+{
+    std::array<int, 4> offset;
+    std::array<int, 4> step;
+    // Samples of a row per pixel of the full width.
+    int samples_per_pixel;
+};
+
+// Run [x_begin, x_end) of masked samples of row y of a plane, with the number of unmasked samples before and after it in the row.
+struct mask_span
+{
+    int y;
+    int x_begin;
+    int x_end;
+    int clean_before;
+    int clean_after;
+};
+
+// [plane] masked runs of the rows, sorted by row and column.
+using mask_spans = std::array<std::vector<mask_span>, 4>;
+
+// One operation of a fill plan. Element k writes dst + k, the offsets are samples of a row (left/right borders) or rows of a plane
+// (top/bottom borders). The elements are written in order.
+struct fill_op
+{
+    enum op_kind : uint8_t
+    {
+        // From src.
+        broadcast,
+        // From src + k, the ranges do not overlap or src is after dst.
+        copy,
+        // From src + k, src is before dst inside the range: the samples written first are read again.
+        copy_forward,
+        // From src - k, the ranges do not overlap.
+        reverse,
+        // fillmargins filter of row src, rows only.
+        blend
+    };
+
+    op_kind kind;
+    int dst;
+    int src;
+    int count;
+};
+
+using fill_plan = std::vector<fill_op>;
+
+// Runs one left/right border operation of a row plan on the row.
+template<typename T_Pixel>
+using row_op_fn = void (*)(const fillborders_kernels<T_Pixel>& kernels, T_Pixel* FB_RESTRICT row_ptr, const fill_op& op) noexcept;
+
+// Left/right border operation of a row plan with the function that runs it, chosen by its kind and size when the plan is built.
+template<typename T_Pixel>
+struct row_op
+{
+    row_op_fn<T_Pixel> run;
+    fill_op op;
+};
+
+// Mode 6: copies `num_cols` columns of `height` rows of a plane to a strip of one line per column (gather) or back (scatter).
+template<typename T_Pixel>
+using gather_columns_fn = void (*)(T_Pixel* FB_RESTRICT strip, const T_Pixel* FB_RESTRICT srcp, size_t stride, int num_cols,
+    int height) noexcept;
+template<typename T_Pixel>
+using scatter_columns_fn = void (*)(T_Pixel* FB_RESTRICT dstp, const T_Pixel* FB_RESTRICT strip, size_t stride, int num_cols,
+    int height) noexcept;
+
+// Time and memory traffic of one fill call per plane. The times of the bands filled on several threads are added up.
+struct fill_stats
+{
+    // Copy of the plane and, for modes 0-4, the left/right borders of its interior rows.
+    std::array<std::atomic<int64_t>, 4> copy_ns;
+    // Top/bottom borders, the borders of modes 5 and 6 and the transient smoothing.
+    std::array<std::atomic<int64_t>, 4> fill_ns;
+    // Bytes read from the source frame and bytes stored in the destination frame (each sample counted once).
+    std::array<int64_t, 4> bytes_read;
+    std::array<int64_t, 4> bytes_written;
+};
+
+// Totals and distribution of the fill times of the frames of one filter instance. Lock-free, updated from any thread.
+class fill_stats_histogram
+{
+    static constexpr int NUM_BUCKETS{48};
+
+    // Bucket b counts the frames that took [2^b, 2^(b+1)) ns.
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_frames{};
+    std::atomic<int64_t> m_frame_ns{};
+    std::array<std::atomic<int64_t>, 4> m_copy_ns{};
+    std::array<std::atomic<int64_t>, 4> m_fill_ns{};
+    std::array<std::atomic<int64_t>, 4> m_bytes_read{};
+    std::array<std::atomic<int64_t>, 4> m_bytes_written{};
+
+public:
+    void add(int64_t frame_ns, const fill_stats& stats) noexcept;
+
+    // One JSON object with the totals per plane and the non-empty buckets.
+    std::string to_json(const std::string& name, int num_planes) const;
+};
+
+// Derives the values of the planes that are not given (num_values 1..3), like for the parameters left, top, right, bottom.
+std::array<int, 4> derive_border_array(std::array<int, 4> result_array, int num_values, int subsample_shift) noexcept;
+
+// Highest instruction set level (OPT_*) supported by the cpu.
+int cpu_opt_level() noexcept;
+
+// Fills the borders of planar and packed frames. Independent of the host, used by the AviSynth+ filter and the C API.
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+class fillborders_core
+{
+public:
+    // Border sizes of every plane and the data derived from them.
+    struct geometry
+    {
+        std::array<int, 4> left{};
+        // [field][component], field 1 (the odd lines) is only used with interlaced=true.
+        std::array<std::array<int, 4>, 2> top{};
+        std::array<int, 4> right{};
+        std::array<std::array<int, 4>, 2> bottom{};
+        // Nothing to fill in the processed planes.
+        bool empty{};
+        std::array<std::array<bool, 4>, 2> fused_rows{};
+        // Modes 0-4: [component] left/right borders of an interior row, [field][component] top/bottom border rows. The sources are
+        // resolved once, the plans only contain samples that are filled.
+        std::array<std::vector<row_op<T_Pixel>>, 4> row_plans{};
+        std::array<std::array<fill_plan, 4>, 2> border_plans{};
+        // Mode 6: [component][left, right] copies of the columns of the left/right borders, unrolled for borders of 1, 2, 4 or 8.
+        std::array<std::array<gather_columns_fn<T_Pixel>, 2>, 4> gather_columns{};
+        std::array<std::array<scatter_columns_fn<T_Pixel>, 2>, 4> scatter_columns{};
+        // [field][component][side], fade weights for mode 5, transient smoothing lerp weights for mode 4.
+        std::array<std::array<std::array<lerp_weights<T_Calc>, 4>, 4>, 2> lerp_tables{};
+    };
+
+private:
+    const fillborders_format m_format;
+    const std::array<int, 4> m_process;
+    const bool m_interlaced;
+    const int m_ts_runtime;
+    const int m_ts_mode_runtime;
+    const std::optional<std::array<T_Calc, 4>> m_fade_target_value;
+    const std::array<float, TS_KERNELSIZE> m_ts_kernel_data;
+    const fillborders_kernels<T_Pixel> m_kernels;
+    const int m_threads;
+    // Geometries seen last, the borders usually change only between scenes.
+    mutable std::mutex m_geometry_cache_mutex;
+    mutable std::vector<std::shared_ptr<const geometry>> m_geometry_cache;
+
+    std::string check_geometry(const geometry& g) const;
+    void finish_geometry(geometry& g) const;
+
+    // Modes 0-4: source of the border sample (or row) `pos` of a line of `size` whose interior is [begin, end). The border sample is
+    // not filled when the source is out of range, wrap falls back to the first/last one.
+    static constexpr int border_source(const int pos, const int begin, const int end, const int size) noexcept
+    {
+        if constexpr (MODE_VAL == 0 || MODE_VAL == 1)
+            return (pos < begin) ? begin : end - 1;
+        else if constexpr (MODE_VAL == 2)
+            return (pos < begin) ? 2 * begin - 1 - pos : 2 * end - 1 - pos;
+        else if constexpr (MODE_VAL == 3)
+            return (pos < begin) ? 2 * begin - pos : 2 * end - 2 - pos;
+        else
+        {
+            const int src{(pos < begin) ? end - begin + pos : pos - end + begin};
+            return (src >= 0 && src < size) ? src : ((pos < begin) ? 0 : size - 1);
+        }
+    }
+
+    void compile_plans(geometry& g) const;
+    void run_row_plan(const std::vector<row_op<T_Pixel>>& plan, T_Pixel* FB_RESTRICT row_ptr) const noexcept;
+    void run_border_plan(const fill_plan& plan, T_Pixel* FB_RESTRICT dstp, int plane_width, size_t stride) const noexcept;
+    int fillmargins_num_stripes(const geometry& g, int plane_width, int plane_height, int component_idx, int field, int num_threads) const
+        noexcept;
+    void fillmargins_stripe_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height, size_t stride,
+        int component_idx, int field, int x_begin, int x_end, T_Pixel* FB_RESTRICT scratch) const noexcept;
+    void fill_rows_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp, const T_Pixel* FB_RESTRICT srcp, int plane_width, int y_begin,
+        int y_end, size_t dst_stride, size_t src_stride, int component_idx) const noexcept;
+    void apply_mode4_transient_smoothing_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height,
+        size_t stride, int component_idx, int field, T_Pixel* FB_RESTRICT temp_buf) const noexcept;
+    void handle_mode_5_fade_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height, size_t stride,
+        int component_idx, int field) const noexcept;
+    void handle_mode_6_fixborders_impl(const geometry& g, T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height, size_t stride,
+        int component_idx, int field) const noexcept;
+    void packed_component_impl(const geometry& g, T_Pixel* FB_RESTRICT base, int step, int width, int height, int stride,
+        int component_idx, int field) const noexcept;
+    // First interior column/row next to one border of one field of a plane, `count` samples at `offset` of the edges of a frame.
+    struct edge_strip
+    {
+        int component_idx;
+        int field;
+        int side;
+        size_t offset;
+        int count;
+    };
+
+    std::vector<edge_strip> edge_strips(const geometry& g) const;
+
+    void fixborders_line_impl(T_Pixel* FB_RESTRICT fill_line, const T_Pixel* FB_RESTRICT ref1_line, const T_Pixel* FB_RESTRICT ref2_line,
+        int line_length, int head_copy_size, int tail_copy_size) const noexcept;
+
+    void smooth_lerp_left_impl(T_Pixel* FB_RESTRICT row_ptr, int border_size, int tr_s, const lerp_weights<T_Calc>& weights) const noexcept;
+    void smooth_lerp_right_impl(
+        T_Pixel* FB_RESTRICT row_ptr, int plane_width, int border_size, int tr_s, const lerp_weights<T_Calc>& weights) const noexcept;
+    void smooth_lerp_top_impl(T_Pixel* FB_RESTRICT dstp, int plane_width, size_t stride, int border_size, int tr_s,
+        const lerp_weights<T_Calc>& weights) const noexcept;
+    void smooth_lerp_bottom_impl(T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int border_size, int tr_s,
+        const lerp_weights<T_Calc>& weights) const noexcept;
+
+    void smooth_gaussian_horizontal_impl(T_Pixel* FB_RESTRICT row_ptr, int plane_width, int border_size, int tr_s, bool is_left_border,
+        T_Pixel* FB_RESTRICT temp_buf, bool modify_original_pixels) const noexcept;
+    void smooth_gaussian_vertical_impl(T_Pixel* FB_RESTRICT dstp, int plane_width, int plane_height, size_t stride, int border_size,
+        int tr_s, bool is_top_border, T_Pixel* FB_RESTRICT temp_rows, bool modify_original_pixels) const noexcept;
+
+public:
+    // process: 1 leave the plane untouched, 2 copy it, 3 fill it. opt_level is one of OPT_*.
+    fillborders_core(const fillborders_format& format, const std::array<int, 4>& process, bool interlaced, int ts, int ts_mode,
+        const std::optional<std::array<T_Calc, 4>>& fade_target_value, int opt_level, int threads);
+
+    // Error message of the invalid settings, empty when they are valid.
+    std::string check() const;
+
+    // Validated geometry of the border sizes of `sizes` (only the sizes are used). It is kept in a small cache.
+    // Returns null and sets `error` when the sizes are invalid.
+    std::shared_ptr<const geometry> get_geometry(geometry&& sizes, std::string& error) const;
+
+    // Copies the planes that are not filled in place and fills the borders of the processed planes.
+    // With `stats` the time and the memory traffic of each plane are added to it.
+    void fill(const geometry& g, const frame_planes& frame, fill_stats* stats = nullptr) const;
+
+    // Error message of the settings that are not supported for packed frames, empty when they are supported.
+    std::string check_packed() const;
+
+    // fill for a packed frame, the components are the planes of the format. Strides are in bytes and can be negative.
+    // Runs on the calling thread. The copy of the frame is counted in the stats of component 0.
+    void fill_packed(const geometry& g, const packed_layout& layout, const uint8_t* srcp, int src_stride, uint8_t* dstp, int dst_stride,
+        fill_stats* stats = nullptr) const noexcept;
+
+    // Error message of the settings that are not supported with a mask, empty when they are supported.
+    std::string check_mask() const;
+
+    // Fills the masked samples of the destination planes in place from the nearest unmasked sample of the row before or after the
+    // run, by the left/right border rule of the mode. A fully masked row repeats the nearest row of its field that is not.
+    // Only the masked samples are stored. Runs on the calling thread.
+    void fill_masked(const mask_spans& spans, const frame_planes& frame, fill_stats* stats = nullptr) const noexcept;
+
+    // Number of samples of the edges of a frame: the interior columns/rows next to the borders of the filled planes.
+    size_t edge_samples(const geometry& g) const;
+
+    // Copies the edges of the source planes of `frame` to `edges` (edge_samples(g) samples).
+    void extract_edges(const geometry& g, const frame_planes& frame, T_Pixel* FB_RESTRICT edges) const;
+
+    // Fills the borders of the destination planes by repeating the median (or the average) of the edges of several frames. A sample
+    // of the edges is filtered across the frames, the corners repeat the ends of the top/bottom edges.
+    void fill_temporal(const geometry& g, const frame_planes& frame, const std::vector<const T_Pixel*>& edges, bool median,
+        fill_stats* stats = nullptr) const;
+};
+
+// Rectangle of a frame with its own mode and border sizes. x, y, width and height are in samples of plane 0, the sizes are per plane
+// and relative to the rectangle.
+struct fill_region_params
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    int mode;
+    std::array<int, 4> left;
+    std::array<int, 4> top;
+    std::array<int, 4> right;
+    std::array<int, 4> bottom;
+};
+
+// Fills the borders of a rectangle inside the frame, in place, with the mode kernels applied to the edges of the rectangle.
+template<typename T_Pixel, typename T_Calc>
+class fillborders_region
+{
+public:
+    virtual ~fillborders_region() = default;
+
+    // Fills the borders of the rectangle in the destination planes of `frame`. With `stats` the time and the bytes written are added.
+    virtual void fill(const frame_planes& frame, fill_stats* stats = nullptr) const = 0;
+
+    // Region of frames of `format`, the other parameters are the ones of fillborders_core. Returns null and sets `error` when the
+    // region or its sizes are invalid.
+    static std::unique_ptr<const fillborders_region> create(const fillborders_format& format, const fill_region_params& region,
+        const std::array<int, 4>& process, bool interlaced, int ts, int ts_mode,
+        const std::optional<std::array<T_Calc, 4>>& fade_target_value, int opt_level, int threads, std::string& error);
+};
+
+// Measures the black/dirty borders of a plane: the number of outer columns/rows (up to a quarter of the plane) whose average is at
+// most `threshold`. Returns {left, top, right, bottom}.
+template<typename T_Pixel>
+std::array<int, 4> detect_plane_borders(
+    const T_Pixel* FB_RESTRICT srcp, const int width, const int height, const int stride, const double threshold)
+{
+    using sum_t = std::conditional_t<std::is_integral_v<T_Pixel>, int64_t, double>;
+
+    const int max_cols{width / 4};
+    const int max_rows{height / 4};
+
+    const auto dark_row{[&](const int y) noexcept {
+        const T_Pixel* FB_RESTRICT const row{srcp + static_cast<int64_t>(y) * stride};
+        sum_t sum{0};
+
+        for (int x{0}; x < width; ++x)
+            sum += row[x];
+
+        return static_cast<double>(sum) <= threshold * width;
+    }};
+
+    int top{0};
+
+    while (top < max_rows && dark_row(top))
+        ++top;
+
+    int bottom{0};
+
+    while (bottom < max_rows && dark_row(height - 1 - bottom))
+        ++bottom;
+
+    // Sums of the outer columns, accumulated a row at a time: [0, max_cols) left, [max_cols, 2 * max_cols) right.
+    std::vector<sum_t> col_sums(static_cast<size_t>(max_cols) * 2);
+
+    for (int y{0}; y < height; ++y)
+    {
+        const T_Pixel* FB_RESTRICT const row{srcp + static_cast<int64_t>(y) * stride};
+
+        for (int x{0}; x < max_cols; ++x)
+            col_sums[x] += row[x];
+
+        for (int x{0}; x < max_cols; ++x)
+            col_sums[max_cols + x] += row[width - max_cols + x];
+    }
+
+    int left{0};
+
+    while (left < max_cols && static_cast<double>(col_sums[left]) <= threshold * height)
+        ++left;
+
+    int right{0};
+
+    while (right < max_cols && static_cast<double>(col_sums[2 * max_cols - 1 - right]) <= threshold * height)
+        ++right;
+
+    return {left, top, right, bottom};
+}
+
+// Masked runs of the rows of a plane of width x height samples. The mask has (width << subsample_shift_w) x
+// (height << subsample_shift_h) samples, a sample of the plane is masked when one of the mask samples it covers is not zero.
+template<typename T_Mask>
+std::vector<mask_span> build_mask_spans(const T_Mask* FB_RESTRICT maskp, const int stride, const int width, const int height,
+    const int subsample_shift_w, const int subsample_shift_h)
+{
+    std::vector<mask_span> spans;
+    std::vector<uint8_t> masked(width);
+
+    for (int y{0}; y < height; ++y)
+    {
+        std::fill(masked.begin(), masked.end(), 0);
+
+        for (int j{0}; j < (1 << subsample_shift_h); ++j)
+        {
+            const T_Mask* FB_RESTRICT const row{maskp + static_cast<int64_t>((y << subsample_shift_h) + j) * stride};
+
+            for (int x{0}; x < width << subsample_shift_w; ++x)
+                masked[x >> subsample_shift_w] |= row[x] != 0;
+        }
+
+        const size_t row_begin{spans.size()};
+        int x{0};
+
+        while (x < width)
+        {
+            if (!masked[x])
+            {
+                ++x;
+                continue;
+            }
+
+            const int x_begin{x};
+
+            while (x < width && masked[x])
+                ++x;
+
+            const int prev_end{(spans.size() > row_begin) ? spans.back().x_end : 0};
+            spans.push_back({y, x_begin, x, x_begin - prev_end, 0});
+        }
+
+        for (size_t k{row_begin}; k < spans.size(); ++k)
+            spans[k].clean_after = ((k + 1 < spans.size()) ? spans[k + 1].x_begin : width) - spans[k].x_end;
+    }
+
+    return spans;
+}
@@ -0,0 +1,277 @@
+#include <immintrin.h>
+
+#include "FillBorders.h"
+
+template<typename T_Pixel>
+void fillmargins_row_avx2(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, const int plane_width) noexcept
+{
+    const int end{fillmargins_row_edges(prev_row, curr_row, plane_width)};
+    // end <= plane_width - 8, so the x + 1 loads of a full vector never leave the row.
+    constexpr int step{32 / sizeof(T_Pixel)};
+    int x{1};
+
+    if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+    {
+        auto filter16{[&](const int offset) {
+            const __m256i p{_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset - 1)))};
+            const __m256i c{_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset)))};
+            const __m256i n{_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset + 1)))};
+            const __m256i pn{_mm256_add_epi16(p, n)};
+
+            return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(pn, _mm256_slli_epi16(pn, 1)), _mm256_slli_epi16(c, 1)), 3);
+        }};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m256i packed{_mm256_packus_epi16(filter16(x), filter16(x + 16))};
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(curr_row + x), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+    }
+    else if constexpr (std::is_same_v<T_Pixel, uint16_t>)
+    {
+        auto filter8{[&](const int offset) {
+            const __m256i p{_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset - 1)))};
+            const __m256i c{_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset)))};
+            const __m256i n{_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + offset + 1)))};
+            const __m256i pn{_mm256_add_epi32(p, n)};
+
+            return _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(pn, _mm256_slli_epi32(pn, 1)), _mm256_slli_epi32(c, 1)), 3);
+        }};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m256i packed{_mm256_packus_epi32(filter8(x), filter8(x + 8))};
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(curr_row + x), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+    }
+    else
+    {
+        const __m256 three{_mm256_set1_ps(3.0f)};
+        const __m256 two{_mm256_set1_ps(2.0f)};
+        const __m256 eighth{_mm256_set1_ps(0.125f)};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m256 p{_mm256_loadu_ps(prev_row + x - 1)};
+            const __m256 c{_mm256_loadu_ps(prev_row + x)};
+            const __m256 n{_mm256_loadu_ps(prev_row + x + 1)};
+
+            // Same evaluation order as the scalar code; multiplying by 1/8 is exact.
+            const __m256 sum{_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(three, p), _mm256_mul_ps(two, c)), _mm256_mul_ps(three, n))};
+            _mm256_storeu_ps(curr_row + x, _mm256_mul_ps(sum, eighth));
+        }
+    }
+
+    for (; x < end; ++x)
+        curr_row[x] = fillmargins_pixel(prev_row, x);
+}
+
+template void fillmargins_row_avx2<uint8_t>(const uint8_t* FB_RESTRICT prev_row, uint8_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_avx2<uint16_t>(
+    const uint16_t* FB_RESTRICT prev_row, uint16_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_avx2<float>(const float* FB_RESTRICT prev_row, float* FB_RESTRICT curr_row, int plane_width) noexcept;
+
+template<typename T_Pixel>
+void fill_span_avx2(T_Pixel* FB_RESTRICT dst, const T_Pixel value, const int count) noexcept
+{
+    constexpr int step{32 / sizeof(T_Pixel)};
+    int x{0};
+
+    if constexpr (std::is_same_v<T_Pixel, float>)
+    {
+        const __m256 v{_mm256_set1_ps(value)};
+
+        for (; x + step <= count; x += step)
+            _mm256_storeu_ps(dst + x, v);
+    }
+    else
+    {
+        const __m256i v{(std::is_same_v<T_Pixel, uint8_t>) ? _mm256_set1_epi8(static_cast<char>(value))
+                                                            : _mm256_set1_epi16(static_cast<short>(value))};
+
+        for (; x + step <= count; x += step)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), v);
+    }
+
+    for (; x < count; ++x)
+        dst[x] = value;
+}
+
+template<typename T_Pixel>
+void reverse_span_avx2(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, const int count) noexcept
+{
+    constexpr int step{32 / sizeof(T_Pixel)};
+    int x{0};
+
+    // dst[x, x + step) are the samples src[-x - step + 1, -x] in reverse order.
+    if constexpr (std::is_same_v<T_Pixel, float>)
+    {
+        const __m256i reverse{_mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)};
+
+        for (; x + step <= count; x += step)
+            _mm256_storeu_ps(dst + x, _mm256_permutevar8x32_ps(_mm256_loadu_ps(src - x - step + 1), reverse));
+    }
+    else
+    {
+        // Reverses each 128-bit lane, then swaps the lanes.
+        const __m256i reverse{_mm256_broadcastsi128_si256((std::is_same_v<T_Pixel, uint8_t>)
+                ? _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+                : _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1))};
+
+        for (; x + step <= count; x += step)
+        {
+            const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src - x - step + 1))};
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, reverse), 0x4E));
+        }
+    }
+
+    for (; x < count; ++x)
+        dst[x] = src[-x];
+}
+
+template void fill_span_avx2<uint8_t>(uint8_t* FB_RESTRICT dst, uint8_t value, int count) noexcept;
+template void fill_span_avx2<uint16_t>(uint16_t* FB_RESTRICT dst, uint16_t value, int count) noexcept;
+template void fill_span_avx2<float>(float* FB_RESTRICT dst, float value, int count) noexcept;
+template void reverse_span_avx2<uint8_t>(uint8_t* FB_RESTRICT dst, const uint8_t* FB_RESTRICT src, int count) noexcept;
+template void reverse_span_avx2<uint16_t>(uint16_t* FB_RESTRICT dst, const uint16_t* FB_RESTRICT src, int count) noexcept;
+template void reverse_span_avx2<float>(float* FB_RESTRICT dst, const float* FB_RESTRICT src, int count) noexcept;
+
+// (fill * w_fill + src * w_src) / size, clamped to max_value; n < 2^32 so the reciprocal division is exact.
+static FB_FORCEINLINE __m256i lerp_epi32_avx2(const __m256i fill, const __m256i src, const __m256i w_fill, const __m256i w_src,
+    const __m256i multiplier, const __m128i shift1, const __m128i shift2, const __m256i max_value) noexcept
+{
+    const __m256i n{_mm256_add_epi32(_mm256_mullo_epi32(fill, w_fill), _mm256_mullo_epi32(src, w_src))};
+    const __m256i t_even{_mm256_srli_epi64(_mm256_mul_epu32(n, multiplier), 32)};
+    const __m256i t_odd{_mm256_mul_epu32(_mm256_srli_epi64(n, 32), multiplier)};
+    const __m256i t{_mm256_blend_epi32(t_even, t_odd, 0xAA)};
+    const __m256i q{_mm256_srl_epi32(_mm256_add_epi32(t, _mm256_srl_epi32(_mm256_sub_epi32(n, t), shift1)), shift2)};
+
+    return _mm256_min_epu32(q, max_value);
+}
+
+template<typename T_Pixel, bool PER_SAMPLE_WEIGHTS>
+static FB_FORCEINLINE void fade_avx2(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    // 16 integer or 8 float samples per iteration.
+    constexpr int step{(std::is_integral_v<T_Pixel>) ? 16 : 8};
+    int x{0};
+
+    if constexpr (std::is_integral_v<T_Pixel>)
+    {
+        const __m256i multiplier{_mm256_set1_epi32(static_cast<int>(weights.divisor.multiplier))};
+        const __m128i shift1{_mm_cvtsi32_si128(weights.divisor.shift1)};
+        const __m128i shift2{_mm_cvtsi32_si128(weights.divisor.shift2)};
+        const __m256i max_value{_mm256_set1_epi32(weights.max_value)};
+        const __m256i fill_const{_mm256_set1_epi32(fill_value)};
+
+        for (; x + step <= count; x += step)
+        {
+            __m256i src_lo, src_hi, fill_lo{fill_const}, fill_hi{fill_const};
+
+            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+            {
+                const __m128i s{_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x))};
+                src_lo = _mm256_cvtepu8_epi32(s);
+                src_hi = _mm256_cvtepu8_epi32(_mm_srli_si128(s, 8));
+
+                if (fill)
+                {
+                    const __m128i f{_mm_loadu_si128(reinterpret_cast<const __m128i*>(fill + x))};
+                    fill_lo = _mm256_cvtepu8_epi32(f);
+                    fill_hi = _mm256_cvtepu8_epi32(_mm_srli_si128(f, 8));
+                }
+            }
+            else
+            {
+                const __m256i s{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + x))};
+                src_lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(s));
+                src_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(s, 1));
+
+                if (fill)
+                {
+                    const __m256i f{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(fill + x))};
+                    fill_lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(f));
+                    fill_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(f, 1));
+                }
+            }
+
+            __m256i w_fill_lo, w_fill_hi, w_src_lo, w_src_hi;
+
+            if constexpr (PER_SAMPLE_WEIGHTS)
+            {
+                w_fill_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights.w_fill.data() + idx + x));
+                w_fill_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights.w_fill.data() + idx + x + 8));
+                w_src_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights.w_src.data() + idx + x));
+                w_src_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights.w_src.data() + idx + x + 8));
+            }
+            else
+            {
+                w_fill_lo = w_fill_hi = _mm256_set1_epi32(weights.w_fill[idx]);
+                w_src_lo = w_src_hi = _mm256_set1_epi32(weights.w_src[idx]);
+            }
+
+            // packus works per 128-bit lane, restore the sample order.
+            const __m256i out{_mm256_permute4x64_epi64(
+                _mm256_packus_epi32(lerp_epi32_avx2(fill_lo, src_lo, w_fill_lo, w_src_lo, multiplier, shift1, shift2, max_value),
+                    lerp_epi32_avx2(fill_hi, src_hi, w_fill_hi, w_src_hi, multiplier, shift1, shift2, max_value)),
+                0xD8)};
+
+            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                    _mm_packus_epi16(_mm256_castsi256_si128(out), _mm256_extracti128_si256(out, 1)));
+            else
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), out);
+        }
+    }
+    else
+    {
+        const __m256 size{_mm256_set1_ps(weights.size)};
+        const __m256 min_value{_mm256_set1_ps(weights.min_value)};
+        const __m256 max_value{_mm256_set1_ps(weights.max_value)};
+        const __m256 fill_const{_mm256_set1_ps(fill_value)};
+
+        for (; x + step <= count; x += step)
+        {
+            const __m256 w_fill{
+                (PER_SAMPLE_WEIGHTS) ? _mm256_loadu_ps(weights.w_fill.data() + idx + x) : _mm256_set1_ps(weights.w_fill[idx])};
+            const __m256 w_src{(PER_SAMPLE_WEIGHTS) ? _mm256_loadu_ps(weights.w_src.data() + idx + x) : _mm256_set1_ps(weights.w_src[idx])};
+            const __m256 f{(fill) ? _mm256_loadu_ps(fill + x) : fill_const};
+            const __m256 v{_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(f, w_fill), _mm256_mul_ps(_mm256_loadu_ps(dst + x), w_src)), size)};
+            // Operand order keeps std::clamp results for signed zeros.
+            _mm256_storeu_ps(dst + x, _mm256_min_ps(max_value, _mm256_max_ps(min_value, v)));
+        }
+    }
+
+    if constexpr (PER_SAMPLE_WEIGHTS)
+        fade_span_c(dst + x, (fill) ? fill + x : nullptr, fill_value, count - x, weights, idx + x);
+    else
+        fade_row_c(dst + x, (fill) ? fill + x : nullptr, fill_value, count - x, weights, idx);
+}
+
+template<typename T_Pixel>
+void fade_row_avx2(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    fade_avx2<T_Pixel, false>(dst, fill, fill_value, count, weights, idx);
+}
+
+template<typename T_Pixel>
+void fade_span_avx2(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    fade_avx2<T_Pixel, true>(dst, fill, fill_value, count, weights, idx);
+}
+
+template void fade_row_avx2<uint8_t>(
+    uint8_t* dst, const uint8_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_row_avx2<uint16_t>(
+    uint16_t* dst, const uint16_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_row_avx2<float>(
+    float* dst, const float* fill, float fill_value, int count, const lerp_weights<float>& weights, int idx) noexcept;
+template void fade_span_avx2<uint8_t>(
+    uint8_t* dst, const uint8_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_span_avx2<uint16_t>(
+    uint16_t* dst, const uint16_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_span_avx2<float>(
+    float* dst, const float* fill, float fill_value, int count, const lerp_weights<float>& weights, int idx) noexcept;
@@ -0,0 +1,64 @@
+#include <immintrin.h>
+
+#include "FillBorders.h"
+
+template<typename T_Pixel>
+void fillmargins_row_avx512(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, const int plane_width) noexcept
+{
+    const int end{fillmargins_row_edges(prev_row, curr_row, plane_width)};
+    // end <= plane_width - 8, so the x + 1 loads of a full vector never leave the row.
+    int x{1};
+
+    if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+    {
+        for (; x + 32 <= end; x += 32)
+        {
+            const __m512i p{_mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x - 1)))};
+            const __m512i c{_mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x)))};
+            const __m512i n{_mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x + 1)))};
+            const __m512i pn{_mm512_add_epi16(p, n)};
+            const __m512i sum{_mm512_add_epi16(_mm512_add_epi16(pn, _mm512_slli_epi16(pn, 1)), _mm512_slli_epi16(c, 1))};
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(curr_row + x), _mm512_cvtepi16_epi8(_mm512_srli_epi16(sum, 3)));
+        }
+    }
+    else if constexpr (std::is_same_v<T_Pixel, uint16_t>)
+    {
+        for (; x + 16 <= end; x += 16)
+        {
+            const __m512i p{_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x - 1)))};
+            const __m512i c{_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x)))};
+            const __m512i n{_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + x + 1)))};
+            const __m512i pn{_mm512_add_epi32(p, n)};
+            const __m512i sum{_mm512_add_epi32(_mm512_add_epi32(pn, _mm512_slli_epi32(pn, 1)), _mm512_slli_epi32(c, 1))};
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(curr_row + x), _mm512_cvtepi32_epi16(_mm512_srli_epi32(sum, 3)));
+        }
+    }
+    else
+    {
+        const __m512 three{_mm512_set1_ps(3.0f)};
+        const __m512 two{_mm512_set1_ps(2.0f)};
+        const __m512 eighth{_mm512_set1_ps(0.125f)};
+
+        for (; x + 16 <= end; x += 16)
+        {
+            const __m512 p{_mm512_loadu_ps(prev_row + x - 1)};
+            const __m512 c{_mm512_loadu_ps(prev_row + x)};
+            const __m512 n{_mm512_loadu_ps(prev_row + x + 1)};
+
+            // Same evaluation order as the scalar code; multiplying by 1/8 is exact.
+            const __m512 sum{_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(three, p), _mm512_mul_ps(two, c)), _mm512_mul_ps(three, n))};
+            _mm512_storeu_ps(curr_row + x, _mm512_mul_ps(sum, eighth));
+        }
+    }
+
+    for (; x < end; ++x)
+        curr_row[x] = fillmargins_pixel(prev_row, x);
+}
+
+template void fillmargins_row_avx512<uint8_t>(
+    const uint8_t* FB_RESTRICT prev_row, uint8_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_avx512<uint16_t>(
+    const uint16_t* FB_RESTRICT prev_row, uint16_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_avx512<float>(const float* FB_RESTRICT prev_row, float* FB_RESTRICT curr_row, int plane_width) noexcept;
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "FillBordersCore.h"
+#include "fillborders.h"
+
+struct fb_config
+{
+    virtual ~fb_config() = default;
+    virtual void fill(const frame_planes& frame) const = 0;
+};
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+class fb_config_impl final : public fb_config
+{
+    using core_t = fillborders_core<T_Pixel, T_Calc, MODE_VAL>;
+
+    core_t m_core;
+    std::shared_ptr<const typename core_t::geometry> m_geometry;
+
+public:
+    fb_config_impl(const fb_params& params, const fillborders_format& format,
+        const std::optional<std::array<T_Calc, 4>>& fade_target_value, const int opt_level, std::string& error)
+        : m_core(format, {params.process[0], params.process[1], params.process[2], params.process[3]}, !!params.interlaced, params.ts,
+              params.ts_mode, fade_target_value, opt_level, params.threads)
+    {
+        error = m_core.check();
+
+        if (!error.empty())
+            return;
+
+        typename core_t::geometry sizes{};
+
+        for (int i{0}; i < 4; ++i)
+        {
+            sizes.left[i] = params.left[i];
+            sizes.right[i] = params.right[i];
+            sizes.top[0][i] = params.top[i];
+            sizes.top[1][i] = (params.top2[i] < 0) ? params.top[i] : params.top2[i];
+            sizes.bottom[0][i] = params.bottom[i];
+            sizes.bottom[1][i] = (params.bottom2[i] < 0) ? params.bottom[i] : params.bottom2[i];
+        }
+
+        if (!params.interlaced && (sizes.top[0] != sizes.top[1] || sizes.bottom[0] != sizes.bottom[1]))
+        {
+            error = "FillBorders: top2 and bottom2 require interlaced=true.";
+            return;
+        }
+
+        m_geometry = m_core.get_geometry(std::move(sizes), error);
+    }
+
+    void fill(const frame_planes& frame) const override
+    {
+        m_core.fill(*m_geometry, frame);
+    }
+};
+
+template<typename T_Pixel, typename T_Calc>
+static fb_config* create_config(const fb_params& params, const fillborders_format& format, const int opt_level, std::string& error)
+{
+    std::optional<std::array<T_Calc, 4>> fade_target_value;
+
+    if (params.has_fade_value)
+    {
+        std::array<T_Calc, 4> targets{};
+
+        for (int i{0}; i < 4; ++i)
+        {
+            if constexpr (std::is_integral_v<T_Calc>)
+                targets[i] = static_cast<T_Calc>(std::clamp(params.fade_value[i], 0.0, static_cast<double>((1 << format.bits) - 1)));
+            else if (!format.rgb && (i == 1 || i == 2))
+                targets[i] = static_cast<T_Calc>(std::clamp(params.fade_value[i], -0.5, 0.5));
+            else
+                targets[i] = static_cast<T_Calc>(std::clamp(params.fade_value[i], 0.0, 1.0));
+        }
+
+        fade_target_value = targets;
+    }
+
+    const auto create{[&]<int MODE_VAL>() -> fb_config* {
+        auto config{std::make_unique<fb_config_impl<T_Pixel, T_Calc, MODE_VAL>>(params, format, fade_target_value, opt_level, error)};
+        return (error.empty()) ? config.release() : nullptr;
+    }};
+
+    switch (params.mode)
+    {
+    case 0:
+        return create.template operator()<0>();
+    case 1:
+        return create.template operator()<1>();
+    case 2:
+        return create.template operator()<2>();
+    case 3:
+        return create.template operator()<3>();
+    case 4:
+        return create.template operator()<4>();
+    case 5:
+        return create.template operator()<5>();
+    default:
+        return create.template operator()<6>();
+    }
+}
+
+static std::string check_params(const fb_params& params, const int cpu_level)
+{
+    if (params.width < 1 || params.height < 1)
+        return "FillBorders: width and height must be greater than 0.";
+
+    if (params.subsampling_w < 0 || params.subsampling_w > 2 || params.subsampling_h < 0 || params.subsampling_h > 2)
+        return "FillBorders: subsampling must be between 0..2.";
+
+    if (params.mode < 0 || params.mode > 6)
+        return "FillBorders: mode must be between 0..6.";
+
+    for (int i{0}; i < std::clamp(params.num_planes, 0, 4); ++i)
+    {
+        if (params.process[i] < 1 || params.process[i] > 3)
+            return "FillBorders: process must be between 1..3.";
+    }
+
+    if (params.opt < -1 || params.opt > OPT_AVX512)
+        return "FillBorders: opt must be between -1..3.";
+
+    if (params.opt > cpu_level)
+    {
+        constexpr const char* opt_errors[]{"", "FillBorders: opt=1 requires SSE4.1.", "FillBorders: opt=2 requires AVX2.",
+            "FillBorders: opt=3 requires AVX512F and AVX512BW."};
+        return opt_errors[params.opt];
+    }
+
+    return {};
+}
+
+void fb_params_init(fb_params* params)
+{
+    *params = {};
+    std::fill_n(params->top2, 4, -1);
+    std::fill_n(params->bottom2, 4, -1);
+    std::fill_n(params->process, 4, 3);
+    params->ts_mode = 1;
+    params->opt = -1;
+    params->threads = 1;
+}
+
+fb_config* fb_config_create(const fb_params* params, char* error, const size_t error_size)
+{
+    std::string message;
+    fb_config* config{};
+
+    try
+    {
+        const int cpu_level{cpu_opt_level()};
+        message = check_params(*params, cpu_level);
+
+        if (message.empty())
+        {
+            const fillborders_format format{params->width, params->height, params->num_planes, params->bits,
+                (params->rgb) ? 0 : params->subsampling_w, (params->rgb) ? 0 : params->subsampling_h, !!params->rgb};
+            const int opt_level{(params->opt == -1) ? cpu_level : params->opt};
+
+            if (params->bits == 8)
+                config = create_config<uint8_t, int>(*params, format, opt_level, message);
+            else if (params->bits == 32)
+                config = create_config<float, float>(*params, format, opt_level, message);
+            else
+                config = create_config<uint16_t, int>(*params, format, opt_level, message);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        message = "FillBorders: out of memory.";
+    }
+
+    if (!config && error && error_size)
+    {
+        const size_t length{std::min(message.size(), error_size - 1)};
+        std::memcpy(error, message.data(), length);
+        error[length] = '\0';
+    }
+
+    return config;
+}
+
+void fb_config_free(fb_config* config)
+{
+    delete config;
+}
+
+int fb_fill(const fb_config* config, const void* const src[4], const ptrdiff_t src_stride[4], void* const dst[4],
+    const ptrdiff_t dst_stride[4])
+{
+    frame_planes frame{};
+
+    for (int i{0}; i < 4; ++i)
+    {
+        frame.srcp[i] = static_cast<const uint8_t*>(src[i]);
+        frame.src_stride[i] = static_cast<int>(src_stride[i]);
+        frame.dstp[i] = static_cast<uint8_t*>(dst[i]);
+        frame.dst_stride[i] = static_cast<int>(dst_stride[i]);
+    }
+
+    try
+    {
+        config->fill(frame);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int fb_detect_borders(const void* plane, const int width, const int height, const ptrdiff_t stride, const int bits,
+    const double threshold, int borders[4])
+{
+    std::array<int, 4> detected;
+
+    if (bits == 8)
+        detected = detect_plane_borders(static_cast<const uint8_t*>(plane), width, height, static_cast<int>(stride), threshold);
+    else if (bits > 8 && bits <= 16)
+        detected = detect_plane_borders(static_cast<const uint16_t*>(plane), width, height, static_cast<int>(stride / 2), threshold);
+    else if (bits == 32)
+        detected = detect_plane_borders(static_cast<const float*>(plane), width, height, static_cast<int>(stride / 4), threshold);
+    else
+        return -1;
+
+    std::copy(detected.begin(), detected.end(), borders);
+    return 0;
+}
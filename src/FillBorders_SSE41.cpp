@@ -0,0 +1,285 @@
+#include <smmintrin.h>
+
+#include "FillBorders.h"
+
+template<typename T_Pixel>
+void fillmargins_row_sse41(const T_Pixel* FB_RESTRICT prev_row, T_Pixel* FB_RESTRICT curr_row, const int plane_width) noexcept
+{
+    const int end{fillmargins_row_edges(prev_row, curr_row, plane_width)};
+    // end <= plane_width - 8, so the x + 1 loads of a full vector never leave the row.
+    constexpr int step{16 / sizeof(T_Pixel)};
+    int x{1};
+
+    if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+    {
+        const __m128i zero{_mm_setzero_si128()};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m128i p{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x - 1))};
+            const __m128i c{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x))};
+            const __m128i n{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x + 1))};
+
+            const __m128i pn_lo{_mm_add_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpacklo_epi8(n, zero))};
+            const __m128i pn_hi{_mm_add_epi16(_mm_unpackhi_epi8(p, zero), _mm_unpackhi_epi8(n, zero))};
+            const __m128i c_lo{_mm_unpacklo_epi8(c, zero)};
+            const __m128i c_hi{_mm_unpackhi_epi8(c, zero)};
+
+            // 3 * (p + n) + 2 * c <= 2040
+            const __m128i sum_lo{_mm_add_epi16(_mm_add_epi16(pn_lo, _mm_slli_epi16(pn_lo, 1)), _mm_slli_epi16(c_lo, 1))};
+            const __m128i sum_hi{_mm_add_epi16(_mm_add_epi16(pn_hi, _mm_slli_epi16(pn_hi, 1)), _mm_slli_epi16(c_hi, 1))};
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(curr_row + x),
+                _mm_packus_epi16(_mm_srli_epi16(sum_lo, 3), _mm_srli_epi16(sum_hi, 3)));
+        }
+    }
+    else if constexpr (std::is_same_v<T_Pixel, uint16_t>)
+    {
+        const __m128i zero{_mm_setzero_si128()};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m128i p{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x - 1))};
+            const __m128i c{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x))};
+            const __m128i n{_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + x + 1))};
+
+            const __m128i pn_lo{_mm_add_epi32(_mm_unpacklo_epi16(p, zero), _mm_unpacklo_epi16(n, zero))};
+            const __m128i pn_hi{_mm_add_epi32(_mm_unpackhi_epi16(p, zero), _mm_unpackhi_epi16(n, zero))};
+            const __m128i c_lo{_mm_unpacklo_epi16(c, zero)};
+            const __m128i c_hi{_mm_unpackhi_epi16(c, zero)};
+
+            const __m128i sum_lo{_mm_add_epi32(_mm_add_epi32(pn_lo, _mm_slli_epi32(pn_lo, 1)), _mm_slli_epi32(c_lo, 1))};
+            const __m128i sum_hi{_mm_add_epi32(_mm_add_epi32(pn_hi, _mm_slli_epi32(pn_hi, 1)), _mm_slli_epi32(c_hi, 1))};
+
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(curr_row + x), _mm_packus_epi32(_mm_srli_epi32(sum_lo, 3), _mm_srli_epi32(sum_hi, 3)));
+        }
+    }
+    else
+    {
+        const __m128 three{_mm_set1_ps(3.0f)};
+        const __m128 two{_mm_set1_ps(2.0f)};
+        const __m128 eighth{_mm_set1_ps(0.125f)};
+
+        for (; x + step <= end; x += step)
+        {
+            const __m128 p{_mm_loadu_ps(prev_row + x - 1)};
+            const __m128 c{_mm_loadu_ps(prev_row + x)};
+            const __m128 n{_mm_loadu_ps(prev_row + x + 1)};
+
+            // Same evaluation order as the scalar code; multiplying by 1/8 is exact.
+            const __m128 sum{_mm_add_ps(_mm_add_ps(_mm_mul_ps(three, p), _mm_mul_ps(two, c)), _mm_mul_ps(three, n))};
+            _mm_storeu_ps(curr_row + x, _mm_mul_ps(sum, eighth));
+        }
+    }
+
+    for (; x < end; ++x)
+        curr_row[x] = fillmargins_pixel(prev_row, x);
+}
+
+template void fillmargins_row_sse41<uint8_t>(
+    const uint8_t* FB_RESTRICT prev_row, uint8_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_sse41<uint16_t>(
+    const uint16_t* FB_RESTRICT prev_row, uint16_t* FB_RESTRICT curr_row, int plane_width) noexcept;
+template void fillmargins_row_sse41<float>(const float* FB_RESTRICT prev_row, float* FB_RESTRICT curr_row, int plane_width) noexcept;
+
+template<typename T_Pixel>
+void fill_span_sse41(T_Pixel* FB_RESTRICT dst, const T_Pixel value, const int count) noexcept
+{
+    constexpr int step{16 / sizeof(T_Pixel)};
+    int x{0};
+
+    if constexpr (std::is_same_v<T_Pixel, float>)
+    {
+        const __m128 v{_mm_set1_ps(value)};
+
+        for (; x + step <= count; x += step)
+            _mm_storeu_ps(dst + x, v);
+    }
+    else
+    {
+        const __m128i v{(std::is_same_v<T_Pixel, uint8_t>) ? _mm_set1_epi8(static_cast<char>(value))
+                                                            : _mm_set1_epi16(static_cast<short>(value))};
+
+        for (; x + step <= count; x += step)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), v);
+    }
+
+    for (; x < count; ++x)
+        dst[x] = value;
+}
+
+template<typename T_Pixel>
+void reverse_span_sse41(T_Pixel* FB_RESTRICT dst, const T_Pixel* FB_RESTRICT src, const int count) noexcept
+{
+    constexpr int step{16 / sizeof(T_Pixel)};
+    int x{0};
+
+    // dst[x, x + step) are the samples src[-x - step + 1, -x] in reverse order.
+    if constexpr (std::is_same_v<T_Pixel, float>)
+    {
+        for (; x + step <= count; x += step)
+        {
+            const __m128 v{_mm_loadu_ps(src - x - step + 1)};
+            _mm_storeu_ps(dst + x, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)));
+        }
+    }
+    else
+    {
+        const __m128i reverse{(std::is_same_v<T_Pixel, uint8_t>)
+                ? _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+                : _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)};
+
+        for (; x + step <= count; x += step)
+        {
+            const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i*>(src - x - step + 1))};
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_shuffle_epi8(v, reverse));
+        }
+    }
+
+    for (; x < count; ++x)
+        dst[x] = src[-x];
+}
+
+template void fill_span_sse41<uint8_t>(uint8_t* FB_RESTRICT dst, uint8_t value, int count) noexcept;
+template void fill_span_sse41<uint16_t>(uint16_t* FB_RESTRICT dst, uint16_t value, int count) noexcept;
+template void fill_span_sse41<float>(float* FB_RESTRICT dst, float value, int count) noexcept;
+template void reverse_span_sse41<uint8_t>(uint8_t* FB_RESTRICT dst, const uint8_t* FB_RESTRICT src, int count) noexcept;
+template void reverse_span_sse41<uint16_t>(uint16_t* FB_RESTRICT dst, const uint16_t* FB_RESTRICT src, int count) noexcept;
+template void reverse_span_sse41<float>(float* FB_RESTRICT dst, const float* FB_RESTRICT src, int count) noexcept;
+
+// (fill * w_fill + src * w_src) / size, clamped to max_value; n < 2^32 so the reciprocal division is exact.
+static FB_FORCEINLINE __m128i lerp_epi32_sse41(const __m128i fill, const __m128i src, const __m128i w_fill, const __m128i w_src,
+    const __m128i multiplier, const __m128i shift1, const __m128i shift2, const __m128i max_value) noexcept
+{
+    const __m128i n{_mm_add_epi32(_mm_mullo_epi32(fill, w_fill), _mm_mullo_epi32(src, w_src))};
+    const __m128i t_even{_mm_srli_epi64(_mm_mul_epu32(n, multiplier), 32)};
+    const __m128i t_odd{_mm_mul_epu32(_mm_srli_epi64(n, 32), multiplier)};
+    const __m128i t{_mm_blend_epi16(t_even, t_odd, 0xCC)};
+    const __m128i q{_mm_srl_epi32(_mm_add_epi32(t, _mm_srl_epi32(_mm_sub_epi32(n, t), shift1)), shift2)};
+
+    return _mm_min_epu32(q, max_value);
+}
+
+template<typename T_Pixel, bool PER_SAMPLE_WEIGHTS>
+static FB_FORCEINLINE void fade_sse41(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    // 8 integer or 4 float samples per iteration.
+    constexpr int step{(std::is_integral_v<T_Pixel>) ? 8 : 4};
+    int x{0};
+
+    if constexpr (std::is_integral_v<T_Pixel>)
+    {
+        const __m128i multiplier{_mm_set1_epi32(static_cast<int>(weights.divisor.multiplier))};
+        const __m128i shift1{_mm_cvtsi32_si128(weights.divisor.shift1)};
+        const __m128i shift2{_mm_cvtsi32_si128(weights.divisor.shift2)};
+        const __m128i max_value{_mm_set1_epi32(weights.max_value)};
+        const __m128i fill_const{_mm_set1_epi32(fill_value)};
+
+        for (; x + step <= count; x += step)
+        {
+            __m128i src_lo, src_hi, fill_lo{fill_const}, fill_hi{fill_const};
+
+            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+            {
+                const __m128i s{_mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst + x))};
+                src_lo = _mm_cvtepu8_epi32(s);
+                src_hi = _mm_cvtepu8_epi32(_mm_srli_si128(s, 4));
+
+                if (fill)
+                {
+                    const __m128i f{_mm_loadl_epi64(reinterpret_cast<const __m128i*>(fill + x))};
+                    fill_lo = _mm_cvtepu8_epi32(f);
+                    fill_hi = _mm_cvtepu8_epi32(_mm_srli_si128(f, 4));
+                }
+            }
+            else
+            {
+                const __m128i s{_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x))};
+                src_lo = _mm_cvtepu16_epi32(s);
+                src_hi = _mm_cvtepu16_epi32(_mm_srli_si128(s, 8));
+
+                if (fill)
+                {
+                    const __m128i f{_mm_loadu_si128(reinterpret_cast<const __m128i*>(fill + x))};
+                    fill_lo = _mm_cvtepu16_epi32(f);
+                    fill_hi = _mm_cvtepu16_epi32(_mm_srli_si128(f, 8));
+                }
+            }
+
+            __m128i w_fill_lo, w_fill_hi, w_src_lo, w_src_hi;
+
+            if constexpr (PER_SAMPLE_WEIGHTS)
+            {
+                w_fill_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights.w_fill.data() + idx + x));
+                w_fill_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights.w_fill.data() + idx + x + 4));
+                w_src_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights.w_src.data() + idx + x));
+                w_src_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights.w_src.data() + idx + x + 4));
+            }
+            else
+            {
+                w_fill_lo = w_fill_hi = _mm_set1_epi32(weights.w_fill[idx]);
+                w_src_lo = w_src_hi = _mm_set1_epi32(weights.w_src[idx]);
+            }
+
+            const __m128i out{_mm_packus_epi32(
+                lerp_epi32_sse41(fill_lo, src_lo, w_fill_lo, w_src_lo, multiplier, shift1, shift2, max_value),
+                lerp_epi32_sse41(fill_hi, src_hi, w_fill_hi, w_src_hi, multiplier, shift1, shift2, max_value))};
+
+            if constexpr (std::is_same_v<T_Pixel, uint8_t>)
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(out, out));
+            else
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), out);
+        }
+    }
+    else
+    {
+        const __m128 size{_mm_set1_ps(weights.size)};
+        const __m128 min_value{_mm_set1_ps(weights.min_value)};
+        const __m128 max_value{_mm_set1_ps(weights.max_value)};
+        const __m128 fill_const{_mm_set1_ps(fill_value)};
+
+        for (; x + step <= count; x += step)
+        {
+            const __m128 w_fill{(PER_SAMPLE_WEIGHTS) ? _mm_loadu_ps(weights.w_fill.data() + idx + x) : _mm_set1_ps(weights.w_fill[idx])};
+            const __m128 w_src{(PER_SAMPLE_WEIGHTS) ? _mm_loadu_ps(weights.w_src.data() + idx + x) : _mm_set1_ps(weights.w_src[idx])};
+            const __m128 f{(fill) ? _mm_loadu_ps(fill + x) : fill_const};
+            const __m128 v{_mm_div_ps(_mm_add_ps(_mm_mul_ps(f, w_fill), _mm_mul_ps(_mm_loadu_ps(dst + x), w_src)), size)};
+            // Operand order keeps std::clamp results for signed zeros.
+            _mm_storeu_ps(dst + x, _mm_min_ps(max_value, _mm_max_ps(min_value, v)));
+        }
+    }
+
+    if constexpr (PER_SAMPLE_WEIGHTS)
+        fade_span_c(dst + x, (fill) ? fill + x : nullptr, fill_value, count - x, weights, idx + x);
+    else
+        fade_row_c(dst + x, (fill) ? fill + x : nullptr, fill_value, count - x, weights, idx);
+}
+
+template<typename T_Pixel>
+void fade_row_sse41(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    fade_sse41<T_Pixel, false>(dst, fill, fill_value, count, weights, idx);
+}
+
+template<typename T_Pixel>
+void fade_span_sse41(T_Pixel* dst, const T_Pixel* fill, const calc_t<T_Pixel> fill_value, const int count,
+    const lerp_weights<calc_t<T_Pixel>>& weights, const int idx) noexcept
+{
+    fade_sse41<T_Pixel, true>(dst, fill, fill_value, count, weights, idx);
+}
+
+template void fade_row_sse41<uint8_t>(
+    uint8_t* dst, const uint8_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_row_sse41<uint16_t>(
+    uint16_t* dst, const uint16_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_row_sse41<float>(
+    float* dst, const float* fill, float fill_value, int count, const lerp_weights<float>& weights, int idx) noexcept;
+template void fade_span_sse41<uint8_t>(
+    uint8_t* dst, const uint8_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_span_sse41<uint16_t>(
+    uint16_t* dst, const uint16_t* fill, int fill_value, int count, const lerp_weights<int>& weights, int idx) noexcept;
+template void fade_span_sse41<float>(
+    float* dst, const float* fill, float fill_value, int count, const lerp_weights<float>& weights, int idx) noexcept;
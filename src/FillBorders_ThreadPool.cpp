@@ -0,0 +1,86 @@
+#include "FillBorders.h"
+
+thread_pool::thread_pool()
+    : m_num_workers{std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0)}
+{
+    for (int i{0}; i < m_num_workers; ++i)
+        std::thread{&thread_pool::worker_loop, this}.detach();
+}
+
+thread_pool& thread_pool::instance()
+{
+    // Never destroyed: the workers sleep until the process exits, joining them while the plugin is unloaded can deadlock.
+    static thread_pool* const pool{new thread_pool()};
+    return *pool;
+}
+
+int thread_pool::max_threads() const noexcept
+{
+    return m_num_workers + 1;
+}
+
+void thread_pool::run_tasks(job& j) noexcept
+{
+    for (int i{j.next.fetch_add(1, std::memory_order_relaxed)}; i < j.count; i = j.next.fetch_add(1, std::memory_order_relaxed))
+    {
+        (*j.task)(i);
+
+        if (j.done.fetch_add(1, std::memory_order_acq_rel) + 1 == j.count)
+            j.done.notify_all();
+    }
+}
+
+void thread_pool::worker_loop()
+{
+    while (true)
+    {
+        std::shared_ptr<job> j;
+
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_wake.wait(lock, [this] { return !m_jobs.empty(); });
+
+            j = m_jobs.front();
+
+            if (--j->helpers == 0)
+                m_jobs.pop_front();
+        }
+
+        run_tasks(*j);
+    }
+}
+
+void thread_pool::run(const int count, const int threads, const std::function<void(int)>& task)
+{
+    const int helpers{std::min({threads, max_threads(), count}) - 1};
+
+    if (helpers <= 0)
+    {
+        for (int i{0}; i < count; ++i)
+            task(i);
+
+        return;
+    }
+
+    const std::shared_ptr<job> j{std::make_shared<job>(&task, count, helpers, 0, 0)};
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_jobs.push_back(j);
+    }
+
+    for (int i{0}; i < helpers; ++i)
+        m_wake.notify_one();
+
+    run_tasks(*j);
+
+    // Tasks taken by the workers can still be running.
+    for (int done{j->done.load(std::memory_order_acquire)}; done < count; done = j->done.load(std::memory_order_acquire))
+        j->done.wait(done, std::memory_order_acquire);
+
+    // A job whose indices were all taken before every helper woke up is still queued.
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (const auto it{std::find(m_jobs.begin(), m_jobs.end(), j)}; it != m_jobs.end())
+        m_jobs.erase(it);
+}
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <VapourSynth4.h>
+
+#include "FillBordersCore.h"
+#include "fillborders.h"
+
+struct FillBordersVS
+{
+    VSNode* node;
+    fb_config* config;
+    int num_planes;
+    bool interlaced;
+    std::array<bool, 3> process;
+};
+
+static const VSFrame* VS_CC fillborders_get_frame(int n, int activation_reason, void* instance_data, [[maybe_unused]] void** frame_data,
+    VSFrameContext* frame_ctx, VSCore* core, const VSAPI* vsapi)
+{
+    const FillBordersVS* d{static_cast<const FillBordersVS*>(instance_data)};
+
+    if (activation_reason == arInitial)
+        vsapi->requestFrameFilter(n, d->node, frame_ctx);
+    else if (activation_reason == arAllFramesReady)
+    {
+        const VSFrame* src_frame{vsapi->getFrameFilter(n, d->node, frame_ctx)};
+
+        if (!d->interlaced) [[likely]]
+        {
+            int error{};
+            const int64_t field_based{vsapi->mapGetInt(vsapi->getFramePropertiesRO(src_frame), "_FieldBased", 0, &error)};
+
+            if (!error && field_based > 0) [[unlikely]]
+            {
+                vsapi->freeFrame(src_frame);
+                vsapi->setFilterError("FillBorders: frame must be not interlaced or use interlaced=1.", frame_ctx);
+                return nullptr;
+            }
+        }
+
+        // The planes of the copy are shared with the source frame. getWritePtr copies a plane only when another reference to it
+        // exists, so the borders of a source frame that is not reused are filled in place.
+        VSFrame* dst_frame{vsapi->copyFrame(src_frame, core)};
+        vsapi->freeFrame(src_frame);
+
+        std::array<void*, 4> dstp{};
+        std::array<ptrdiff_t, 4> stride{};
+
+        for (int i{0}; i < d->num_planes; ++i)
+        {
+            if (!d->process[i])
+                continue;
+
+            dstp[i] = vsapi->getWritePtr(dst_frame, i);
+            stride[i] = vsapi->getStride(dst_frame, i);
+        }
+
+        if (fb_fill(d->config, dstp.data(), stride.data(), dstp.data(), stride.data())) [[unlikely]]
+        {
+            vsapi->freeFrame(dst_frame);
+            vsapi->setFilterError("FillBorders: out of memory.", frame_ctx);
+            return nullptr;
+        }
+
+        return dst_frame;
+    }
+
+    return nullptr;
+}
+
+static void VS_CC fillborders_free(void* instance_data, [[maybe_unused]] VSCore* core, const VSAPI* vsapi)
+{
+    FillBordersVS* d{static_cast<FillBordersVS*>(instance_data)};
+    vsapi->freeNode(d->node);
+    fb_config_free(d->config);
+    delete d;
+}
+
+static void VS_CC fillborders_create(const VSMap* in, VSMap* out, [[maybe_unused]] void* user_data, VSCore* core, const VSAPI* vsapi)
+{
+    auto d{std::make_unique<FillBordersVS>()};
+    d->node = vsapi->mapGetNode(in, "clip", 0, nullptr);
+    const VSVideoInfo* vi{vsapi->getVideoInfo(d->node)};
+
+    const auto fail{[&](const char* message) {
+        vsapi->mapSetError(out, message);
+        vsapi->freeNode(d->node);
+    }};
+
+    if (vi->format.colorFamily == cfUndefined || !vi->width || !vi->height)
+        return fail("FillBorders: only constant format input supported.");
+
+    if (vi->format.sampleType == stFloat && vi->format.bitsPerSample != 32)
+        return fail("FillBorders: only 32-bit float samples are supported.");
+
+    fb_params params;
+    fb_params_init(&params);
+    params.width = vi->width;
+    params.height = vi->height;
+    params.bits = vi->format.bitsPerSample;
+    params.num_planes = vi->format.numPlanes;
+    params.subsampling_w = vi->format.subSamplingW;
+    params.subsampling_h = vi->format.subSamplingH;
+    params.rgb = vi->format.colorFamily == cfRGB;
+    d->num_planes = vi->format.numPlanes;
+
+    // Sizes not given for all planes are derived like in the AviSynth filter.
+    const auto read_borders{[&](const char* key, const int subsample_shift, int* border) {
+        const int num_values{vsapi->mapNumElements(in, key)};
+
+        if (num_values <= 0)
+            return true;
+
+        if (num_values > vi->format.numPlanes)
+        {
+            const std::string message{std::string{"FillBorders: more "} + key + " values given than there are planes."};
+            fail(message.c_str());
+            return false;
+        }
+
+        std::array<int, 4> values{};
+
+        for (int i{0}; i < num_values; ++i)
+            values[i] = vsapi->mapGetIntSaturated(in, key, i, nullptr);
+
+        values = derive_border_array(values, num_values, subsample_shift);
+        std::copy(values.begin(), values.end(), border);
+        return true;
+    }};
+
+    if (!read_borders("left", params.subsampling_w, params.left) || !read_borders("right", params.subsampling_w, params.right) ||
+        !read_borders("top", params.subsampling_h, params.top) || !read_borders("bottom", params.subsampling_h, params.bottom) ||
+        !read_borders("top2", params.subsampling_h, params.top2) || !read_borders("bottom2", params.subsampling_h, params.bottom2))
+        return;
+
+    int error{};
+    const char* mode{vsapi->mapGetData(in, "mode", 0, &error)};
+    constexpr std::array<const char*, 7> mode_names{"fillmargins", "repeat", "mirror", "reflect", "wrap", "fade", "fixborders"};
+
+    if (error)
+        params.mode = 1;
+    else
+    {
+        const auto it{std::find_if(mode_names.begin(), mode_names.end(), [&](const char* name) { return !std::strcmp(name, mode); })};
+
+        if (it == mode_names.end())
+            return fail("FillBorders: invalid mode. Valid values are 'fillmargins', 'repeat', 'mirror', 'reflect', 'wrap', 'fade' and "
+                        "'fixborders'.");
+
+        params.mode = static_cast<int>(it - mode_names.begin());
+    }
+
+    d->interlaced = !!vsapi->mapGetInt(in, "interlaced", 0, &error);
+    params.interlaced = d->interlaced;
+
+    if (const int ts{vsapi->mapGetIntSaturated(in, "ts", 0, &error)}; !error)
+        params.ts = ts;
+
+    if (const int ts_mode{vsapi->mapGetIntSaturated(in, "ts_mode", 0, &error)}; !error)
+        params.ts_mode = ts_mode;
+
+    if (const int num_fade_values{vsapi->mapNumElements(in, "fade_value")}; num_fade_values > 0)
+    {
+        if (num_fade_values != 1 && num_fade_values != vi->format.numPlanes)
+            return fail("FillBorders: fade_value must have 1 element or one element per plane.");
+
+        params.has_fade_value = 1;
+
+        for (int i{0}; i < 4; ++i)
+            params.fade_value[i] = vsapi->mapGetFloat(in, "fade_value", std::min(i, num_fade_values - 1), nullptr);
+    }
+
+    if (const int num_planes{vsapi->mapNumElements(in, "planes")}; num_planes > 0)
+    {
+        d->process = {};
+
+        for (int i{0}; i < num_planes; ++i)
+        {
+            const int plane{vsapi->mapGetIntSaturated(in, "planes", i, nullptr)};
+
+            if (plane < 0 || plane >= vi->format.numPlanes)
+                return fail("FillBorders: plane index out of range.");
+
+            if (d->process[plane])
+                return fail("FillBorders: plane specified twice.");
+
+            d->process[plane] = true;
+        }
+    }
+    else
+        d->process = {true, true, true};
+
+    // The planes that are not processed stay shared with the source frame.
+    for (int i{0}; i < 3; ++i)
+        params.process[i] = (d->process[i]) ? 3 : 1;
+
+    if (const int opt{vsapi->mapGetIntSaturated(in, "opt", 0, &error)}; !error)
+        params.opt = opt;
+
+    if (const int threads{vsapi->mapGetIntSaturated(in, "threads", 0, &error)}; !error)
+        params.threads = threads;
+
+    char message[256];
+    d->config = fb_config_create(&params, message, sizeof(message));
+
+    if (!d->config)
+        return fail(message);
+
+    const VSFilterDependency deps[]{{d->node, rpStrictSpatial}};
+    vsapi->createVideoFilter(out, "FillBorders", vi, fillborders_get_frame, fillborders_free, fmParallel, deps, 1, d.get(), core);
+    d.release();
+}
+
+VS_EXTERNAL_API(void) VapourSynthPluginInit2(VSPlugin* plugin, const VSPLUGINAPI* vspapi)
+{
+    vspapi->configPlugin(
+        "com.asd.fillborders", "fb", "Fills the borders of a clip", VS_MAKE_VERSION(1, 6), VAPOURSYNTH_API_VERSION, 0, plugin);
+
+    vspapi->registerFunction("FillBorders",
+        "clip:vnode;"
+        "left:int[]:opt;"
+        "top:int[]:opt;"
+        "right:int[]:opt;"
+        "bottom:int[]:opt;"
+        "mode:data:opt;"
+        "interlaced:int:opt;"
+        "ts:int:opt;"
+        "ts_mode:int:opt;"
+        "fade_value:float[]:opt;"
+        "planes:int[]:opt;"
+        "opt:int:opt;"
+        "top2:int[]:opt;"
+        "bottom2:int[]:opt;"
+        "threads:int:opt;",
+        "clip:vnode;", fillborders_create, nullptr, plugin);
+}
@@ -0,0 +1,1289 @@
+// Differential test of the filter against the fill code of 1.5.0 (fillborders_reference.h), through the mock of the AviSynth+ API in
+// tests/mock/avisynth.h.
+//
+// fillborders_tests [cases] [seed]
+//
+// Every case is a random format and geometry: odd plane widths, borders up to (and sometimes past) the "borders are too big" limit,
+// every ts/ts_mode and fade_value shape. The filter must reject exactly the geometries the reference rejected and otherwise return the
+// same bytes as the reference, padding included, with every opt supported by the CPU, with 1 and several threads, in place and into a
+// new frame.
+//
+// Some cases add one feature to the borders, checked against the rules of the README written again here:
+// - a mask (modes 0..3), greyscale or with the planes (and subsampling) of the clip, of a random bit depth;
+// - a packed format (YUY2, RGB24/32/48/64), compared with the fill of its components as planes;
+// - regions, whose borders are filled like the ones of a cropped plane;
+// - border sizes read from frame properties (borders_from_props);
+// - detected borders (autodetect), on a first plane with dark borders;
+// - mode 7 on a clip of several frames, requested in and out of order.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <avisynth.h>
+
+#include "fillborders_reference.h"
+
+extern "C" const char* __stdcall AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors);
+
+namespace
+{
+using planes_t = std::array<std::vector<uint8_t>, 4>;
+
+// What a case adds to the borders.
+enum class case_kind
+{
+    borders,
+    greyscale_mask,
+    planar_mask,
+    packed,
+    regions,
+    props,
+    autodetect,
+    temporal,
+    count
+};
+
+constexpr const char* case_kind_names[]{
+    "borders", "greyscale mask", "planar mask", "packed", "regions", "borders_from_props", "autodetect", "temporal"};
+
+struct params
+{
+    case_kind kind;
+    int width;
+    int height;
+    int bits;
+    int num_planes;
+    int subsampling_w;
+    int subsampling_h;
+    bool rgb;
+    // 0 for the planar formats, otherwise the bytes of one pixel (2 for YUY2, 3/4/6/8 for RGB24/32/48/64).
+    int packed_bytes;
+    std::array<int, 4> left{};
+    std::array<int, 4> top{};
+    std::array<int, 4> right{};
+    std::array<int, 4> bottom{};
+    int mode;
+    std::array<int, 4> process{3, 3, 3, 3};
+    bool interlaced;
+    int ts;
+    int ts_mode;
+    // 0 no fade_value, 1 one value for all the planes, otherwise one value per plane.
+    int fade_values;
+    std::array<double, 4> fade_value{};
+};
+
+struct layout
+{
+    int num_planes{};
+    int sample_size{};
+    std::array<int, 4> width{};
+    std::array<int, 4> height{};
+    std::array<ptrdiff_t, 4> stride{};
+};
+
+// The arguments a case kind adds to the filter and its fill of the expected frames after the borders.
+struct extras
+{
+    std::vector<std::pair<const char*, AVSValue>> args;
+    // left, top, right, bottom given to the filter, the sizes of the case unless they are read from the frames.
+    std::array<std::array<int, 4>, 4> borders{};
+    // Whether the reference accepts what the case adds.
+    bool valid{true};
+    // Fill of the expected frame n, from the planes of the source frames.
+    std::function<void(planes_t& expected, const layout& l, int n, const std::vector<planes_t>& src, const layout& src_layout)> fill;
+};
+
+struct counters
+{
+    std::array<int, 8> compared{};
+    std::array<int, 8> rejected{};
+    std::array<int, static_cast<int>(case_kind::count)> compared_kinds{};
+    int failures{};
+};
+
+int random_int(std::mt19937& rng, const int min, const int max)
+{
+    return std::uniform_int_distribution<int>{min, max}(rng);
+}
+
+// A border size for a side that may use up to `limit` samples: often none, small or right at the limit.
+int random_border(std::mt19937& rng, const int limit)
+{
+    if (limit <= 0)
+        return 0;
+
+    switch (random_int(rng, 0, 3))
+    {
+    case 0:
+        return 0;
+    case 1:
+        return std::min(limit, random_int(rng, 1, 4));
+    case 2:
+        return std::max(0, limit - random_int(rng, 0, 2));
+    default:
+        return random_int(rng, 0, limit);
+    }
+}
+
+// Border sizes of a plane (a field with interlaced=true) of w x h samples for `mode`, the regions use it for their rectangles too.
+void random_plane_borders(std::mt19937& rng, const int mode, const int ts, const int w, const int h, int& left, int& top, int& right,
+    int& bottom)
+{
+    if (mode == 2 || mode == 3)
+    {
+        left = random_border(rng, w / 2);
+        right = random_border(rng, w / 2);
+        top = random_border(rng, h / 2);
+        bottom = random_border(rng, h / 2);
+    }
+    else
+    {
+        left = random_border(rng, w);
+        right = random_border(rng, w - left);
+        top = random_border(rng, h);
+        bottom = random_border(rng, h - top);
+    }
+
+    // Mode 4 rejects ts larger than a border, keep most of the cases valid.
+    if (mode == 4 && ts > 0 && random_int(rng, 0, 3))
+    {
+        for (int* border : {&left, &right, &top, &bottom})
+        {
+            if (*border > 0)
+                *border = std::max(*border, ts);
+        }
+    }
+
+    // Past the limit by one sample.
+    if (random_int(rng, 0, 19) == 0)
+        ++((random_int(rng, 0, 1)) ? right : bottom);
+
+    // The filter read outside of the plane for a left/right border of the whole width (modes 0 and 1) and for the ts of a border of
+    // the whole width/height (mode 4): nothing to compare with.
+    if (mode <= 1 || (mode == 4 && ts > 0))
+    {
+        left = std::min(left, w - 1);
+        right = std::min(right, w - 1);
+    }
+
+    if (mode == 4 && ts > 0)
+    {
+        top = std::min(top, h - 1);
+        bottom = std::min(bottom, h - 1);
+    }
+}
+
+std::string describe(const params& p)
+{
+    char text[576];
+    std::snprintf(text, sizeof(text),
+        "%s, mode %d, %d bit, %d planes%s, packed %d, subsampling %d/%d, %dx%d%s, ts %d/%d, fade %d (%g %g %g %g), "
+        "process %d %d %d %d, left %d %d %d %d, top %d %d %d %d, right %d %d %d %d, bottom %d %d %d %d",
+        case_kind_names[static_cast<int>(p.kind)], p.mode, p.bits, p.num_planes, (p.rgb) ? " rgb" : "", p.packed_bytes, p.subsampling_w,
+        p.subsampling_h, p.width, p.height, (p.interlaced) ? " interlaced" : "", p.ts, p.ts_mode, p.fade_values, p.fade_value[0],
+        p.fade_value[1], p.fade_value[2], p.fade_value[3], p.process[0], p.process[1], p.process[2], p.process[3], p.left[0],
+        p.left[1], p.left[2], p.left[3], p.top[0], p.top[1], p.top[2], p.top[3], p.right[0], p.right[1], p.right[2], p.right[3],
+        p.bottom[0], p.bottom[1], p.bottom[2], p.bottom[3]);
+    return text;
+}
+
+// Most cases only fill the borders.
+case_kind random_kind(std::mt19937& rng)
+{
+    const int kind{random_int(rng, 0, 15)};
+    return (kind < static_cast<int>(case_kind::count)) ? static_cast<case_kind>(kind) : case_kind::borders;
+}
+
+params random_params(std::mt19937& rng, const case_kind kind)
+{
+    params p{};
+    p.kind = kind;
+
+    constexpr int all_bits[]{8, 10, 12, 16, 32};
+    // The mask supports modes 0..3, the packed formats have no mode 6, mode 7 gets the borders of mode 1.
+    p.mode = random_int(rng, 0, (kind == case_kind::greyscale_mask || kind == case_kind::planar_mask) ? 3 : 6);
+
+    if (kind == case_kind::packed)
+    {
+        p.mode = std::min(p.mode, 5);
+        p.packed_bytes = std::array{2, 3, 4, 6, 8}[random_int(rng, 0, 4)];
+        p.bits = (p.packed_bytes >= 6) ? 16 : 8;
+        p.num_planes = (p.packed_bytes == 4 || p.packed_bytes == 8) ? 4 : 3;
+        p.rgb = p.packed_bytes != 2;
+        p.subsampling_w = (p.rgb) ? 0 : 1;
+    }
+    else
+    {
+        if (kind == case_kind::temporal)
+            p.mode = 1;
+
+        p.bits = all_bits[random_int(rng, 0, 4)];
+        p.num_planes = std::array{1, 3, 3, 4}[random_int(rng, 0, 3)];
+        p.rgb = p.num_planes > 1 && random_int(rng, 0, 3) == 0;
+        p.subsampling_w = (p.num_planes > 1 && !p.rgb) ? random_int(rng, 0, 2) : 0;
+        p.subsampling_h = (p.num_planes > 1 && !p.rgb) ? random_int(rng, 0, 1) : 0;
+    }
+
+    p.interlaced = random_int(rng, 0, 3) == 0;
+
+    // Odd widths (of the subsampled planes too), sometimes wide enough for the SIMD code and the column stripes of mode 0.
+    const int chroma_width{(random_int(rng, 0, 3) == 0) ? random_int(rng, 128, 560) * 2 + 1 : random_int(rng, 0, 48) * 2 + 1};
+    const int field_mod{(p.interlaced) ? 2 : 1};
+    p.width = chroma_width << p.subsampling_w;
+    p.height = random_int(rng, 1, 48) * (field_mod << p.subsampling_h);
+
+    // The packed formats do not support ts.
+    p.ts = (kind == case_kind::packed) ? 0 : random_int(rng, 0, 5);
+    p.ts_mode = random_int(rng, 0, 2);
+
+    // y, u and v do not apply to RGB clips, the R, G and B planes are always filled.
+    for (int i{0}; i < 4; ++i)
+        p.process[i] = (p.rgb && i < 3) ? 3 : std::array{1, 2, 3, 3, 3, 3}[random_int(rng, 0, 5)];
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        const bool chroma{!p.rgb && (i == 1 || i == 2)};
+        const int w{(chroma) ? p.width >> p.subsampling_w : p.width};
+        const int h{((chroma) ? p.height >> p.subsampling_h : p.height) / field_mod};
+        random_plane_borders(rng, p.mode, p.ts, w, h, p.left[i], p.top[i], p.right[i], p.bottom[i]);
+    }
+
+    // Fade shapes: none, one value for all the planes, one value per plane; sometimes out of the range of the samples.
+    if (p.mode == 5 && random_int(rng, 0, 2))
+    {
+        p.fade_values = random_int(rng, 1, 2);
+
+        for (int i{0}; i < 4; ++i)
+        {
+            if (p.fade_values == 1 && i > 0)
+                p.fade_value[i] = p.fade_value[0];
+            else if (p.bits == 32)
+                p.fade_value[i] = static_cast<float>(std::uniform_real_distribution<double>{-0.7, 1.2}(rng));
+            else
+                p.fade_value[i] = random_int(rng, -20, (1 << p.bits) + 20);
+        }
+    }
+
+    if (kind == case_kind::temporal)
+        p.mode = 7;
+
+    return p;
+}
+
+VideoInfo video_info(const params& p)
+{
+    VideoInfo vi;
+    vi.width = p.width;
+    vi.height = p.height;
+    vi.bits = p.bits;
+    vi.num_components = p.num_planes;
+    vi.subsampling_w = p.subsampling_w;
+    vi.subsampling_h = p.subsampling_h;
+    vi.rgb = p.rgb;
+    vi.packed_bytes = p.packed_bytes;
+    return vi;
+}
+
+// The planes of the components, in the order of the filter.
+std::array<int, 4> plane_order(const params& p)
+{
+    if (p.rgb)
+        return {PLANAR_R, PLANAR_G, PLANAR_B, PLANAR_A};
+
+    return {PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A};
+}
+
+// The planes of a frame: the planes of the components, or the single plane of a packed frame.
+int num_frame_planes(const params& p)
+{
+    return (p.packed_bytes) ? 1 : p.num_planes;
+}
+
+int frame_plane(const params& p, const int i)
+{
+    return (p.packed_bytes) ? 0 : plane_order(p)[i];
+}
+
+// Width and height of plane i of the clip.
+std::pair<int, int> plane_size(const params& p, const int i)
+{
+    const bool chroma{!p.rgb && (i == 1 || i == 2)};
+    return {(chroma) ? p.width >> p.subsampling_w : p.width, (chroma) ? p.height >> p.subsampling_h : p.height};
+}
+
+layout frame_layout(const params& p, const PVideoFrame& frame)
+{
+    layout l{num_frame_planes(p), (p.bits == 8) ? 1 : ((p.bits == 32) ? 4 : 2)};
+
+    for (int i{0}; i < l.num_planes; ++i)
+    {
+        const int plane{frame_plane(p, i)};
+        l.width[i] = frame->GetRowSize(plane) / l.sample_size;
+        l.height[i] = frame->GetHeight(plane);
+        l.stride[i] = frame->GetPitch(plane);
+    }
+
+    return l;
+}
+
+// Every byte of the planes of a frame, padding included.
+planes_t frame_planes(const params& p, const PVideoFrame& frame)
+{
+    planes_t planes;
+
+    for (int i{0}; i < num_frame_planes(p); ++i)
+    {
+        const int plane{frame_plane(p, i)};
+        const uint8_t* data{frame->GetReadPtr(plane)};
+        planes[i].assign(data, data + static_cast<size_t>(frame->GetPitch(plane)) * frame->GetHeight(plane));
+    }
+
+    return planes;
+}
+
+template<typename T_Pixel>
+void randomize_frame(const params& p, PVideoFrame& frame, std::mt19937& rng)
+{
+    for (int i{0}; i < num_frame_planes(p); ++i)
+    {
+        const int plane{frame_plane(p, i)};
+        uint8_t* data{frame->GetWritePtr(plane)};
+
+        for (size_t x{0}; x < static_cast<size_t>(frame->GetPitch(plane)) * frame->GetHeight(plane) / sizeof(T_Pixel); ++x)
+        {
+            T_Pixel sample;
+
+            if constexpr (std::is_floating_point_v<T_Pixel>)
+                sample = std::uniform_real_distribution<float>{0.0f, 1.0f}(rng) - ((!p.rgb && (i == 1 || i == 2)) ? 0.5f : 0.0f);
+            else
+                sample = static_cast<T_Pixel>(rng() & ((1u << p.bits) - 1));
+
+            std::memcpy(data + x * sizeof(T_Pixel), &sample, sizeof(T_Pixel));
+        }
+    }
+}
+
+// Offset and step, in samples, of component i in a packed row: YUY2 is Y0 U Y1 V, packed RGB is B, G, R(, A).
+std::pair<int, int> packed_component(const params& p, const int i)
+{
+    if (!p.rgb)
+        return {std::array{0, 1, 3}[i], (i == 0) ? 2 : 4};
+
+    return {std::array{2, 1, 0, 3}[i], p.num_planes};
+}
+
+// Row of a packed frame that holds row y of the picture, packed RGB is stored bottom-up.
+int packed_row(const params& p, const int y)
+{
+    return (p.rgb) ? p.height - 1 - y : y;
+}
+
+// The components of a packed frame as planes without padding.
+template<typename T_Pixel>
+planes_t unpack(const params& p, const planes_t& packed, const layout& packed_layout, layout& planar_layout)
+{
+    planes_t planes;
+    planar_layout = {p.num_planes, packed_layout.sample_size};
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        const auto [width, height]{plane_size(p, i)};
+        const auto [offset, step]{packed_component(p, i)};
+        planar_layout.width[i] = width;
+        planar_layout.height[i] = height;
+        planar_layout.stride[i] = static_cast<ptrdiff_t>(width) * sizeof(T_Pixel);
+        planes[i].resize(static_cast<size_t>(planar_layout.stride[i]) * height);
+
+        for (int y{0}; y < height; ++y)
+        {
+            const T_Pixel* src{reinterpret_cast<const T_Pixel*>(packed[0].data() + packed_row(p, y) * packed_layout.stride[0])};
+            T_Pixel* dst{reinterpret_cast<T_Pixel*>(planes[i].data() + y * planar_layout.stride[i])};
+
+            for (int x{0}; x < width; ++x)
+                dst[x] = src[offset + x * step];
+        }
+    }
+
+    return planes;
+}
+
+// Stores the planes of unpack in a packed frame.
+template<typename T_Pixel>
+void pack(const params& p, const planes_t& planes, const layout& planar_layout, planes_t& packed, const layout& packed_layout)
+{
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        const auto [offset, step]{packed_component(p, i)};
+
+        for (int y{0}; y < planar_layout.height[i]; ++y)
+        {
+            const T_Pixel* src{reinterpret_cast<const T_Pixel*>(planes[i].data() + y * planar_layout.stride[i])};
+            T_Pixel* dst{reinterpret_cast<T_Pixel*>(packed[0].data() + packed_row(p, y) * packed_layout.stride[0])};
+
+            for (int x{0}; x < planar_layout.width[i]; ++x)
+                dst[offset + x * step] = src[x];
+        }
+    }
+}
+
+// A clip of the given frames. With copy, every request gets a new copy of its frame (uniquely owned, so the filter fills it in place).
+class test_clip : public IClip
+{
+    VideoInfo m_vi;
+    std::vector<PVideoFrame> m_frames;
+    const bool m_copy;
+
+public:
+    test_clip(const VideoInfo& vi, const std::vector<PVideoFrame>& frames, const bool copy) : m_vi(vi), m_frames(frames), m_copy(copy)
+    {
+        m_vi.num_frames = static_cast<int>(m_frames.size());
+    }
+
+    PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment*) override
+    {
+        return (m_copy) ? PVideoFrame{new VideoFrame(*m_frames[n].operator->())} : m_frames[n];
+    }
+
+    const VideoInfo& __stdcall GetVideoInfo() override
+    {
+        return m_vi;
+    }
+};
+
+AVSValue int_array(const std::array<int, 4>& values, const int size)
+{
+    return AVSValue(std::vector<AVSValue>(values.begin(), values.begin() + size));
+}
+
+PClip fill_borders(IScriptEnvironment& env, const params& p, const extras& extra, const PClip& clip, const int opt, const int threads)
+{
+    std::vector<std::pair<const char*, AVSValue>> args{{nullptr, clip}, {"left", int_array(extra.borders[0], p.num_planes)},
+        {"top", int_array(extra.borders[1], p.num_planes)}, {"right", int_array(extra.borders[2], p.num_planes)},
+        {"bottom", int_array(extra.borders[3], p.num_planes)}, {"mode", p.mode}, {"y", p.process[0]}, {"u", p.process[1]},
+        {"v", p.process[2]}, {"a", p.process[3]}, {"interlaced", p.interlaced}, {"ts", p.ts}, {"ts_mode", p.ts_mode}, {"opt", opt},
+        {"threads", threads}};
+
+    if (p.fade_values)
+    {
+        std::vector<AVSValue> fade;
+
+        for (int i{0}; i < ((p.fade_values == 1) ? 1 : p.num_planes); ++i)
+            fade.push_back((p.bits == 32) ? AVSValue(static_cast<float>(p.fade_value[i])) : AVSValue(static_cast<int>(p.fade_value[i])));
+
+        args.emplace_back("fade_value", AVSValue(fade));
+    }
+
+    args.insert(args.end(), extra.args.begin(), extra.args.end());
+    return env.call("FillBorders", args).AsClip();
+}
+
+void copy_plane(const planes_t& src, const layout& src_layout, planes_t& dst, const layout& dst_layout, const int i)
+{
+    for (int y{0}; y < src_layout.height[i]; ++y)
+        std::memcpy(dst[i].data() + y * dst_layout.stride[i], src[i].data() + y * src_layout.stride[i],
+            static_cast<size_t>(src_layout.width[i]) * src_layout.sample_size);
+}
+
+// fade_value clamped like the filter did; a single -1 is the default (no fade_value).
+template<typename T_Calc>
+std::optional<std::array<T_Calc, 4>> reference_fade_value(const params& p)
+{
+    if (!p.fade_values || ((p.fade_values == 1 || p.num_planes == 1) && p.bits != 32 && p.fade_value[0] == -1))
+        return std::nullopt;
+
+    std::array<T_Calc, 4> targets{};
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        if constexpr (std::is_integral_v<T_Calc>)
+            targets[i] = std::clamp(static_cast<int>(p.fade_value[i]), 0, (1 << p.bits) - 1);
+        else
+            targets[i] = (!p.rgb && (i == 1 || i == 2)) ? std::clamp(static_cast<float>(p.fade_value[i]), -0.5f, 0.5f)
+                                                        : std::clamp(static_cast<float>(p.fade_value[i]), 0.0f, 1.0f);
+    }
+
+    return targets;
+}
+
+// Fills the planes (fields with interlaced=true) at `offset` (x, y of the first plane) of the frame with filler, in the planes with
+// process 3. Without copy the planes are filled in place.
+template<typename T_Pixel, typename T_Filler>
+void fill_planes(const params& p, const T_Filler& filler, const std::array<int, 4>& process, const std::array<int, 4>& widths,
+    const std::array<int, 4>& heights, const std::pair<int, int>& offset, planes_t& dst, const layout& dst_layout)
+{
+    const int num_fields{(p.interlaced) ? 2 : 1};
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        if (process[i] != 3)
+            continue;
+
+        const bool chroma{!p.rgb && (i == 1 || i == 2)};
+        const int lerp_plane_category{(chroma) ? i : 0};
+        const int stride{static_cast<int>(dst_layout.stride[i] / sizeof(T_Pixel))};
+        T_Pixel* const origin{reinterpret_cast<T_Pixel*>(dst[i].data()) +
+                              static_cast<ptrdiff_t>((chroma) ? offset.second >> p.subsampling_h : offset.second) * stride +
+                              ((chroma) ? offset.first >> p.subsampling_w : offset.first)};
+
+        for (int field{0}; field < num_fields; ++field)
+            filler.fill_plane(origin + field * stride, widths[i], heights[i] / num_fields, stride * num_fields, i, p.bits,
+                lerp_plane_category);
+    }
+}
+
+// What the filter returned for a destination frame that holds `dst` before the call.
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+planes_t reference_frame(const params& p, const reference::reference_filler<T_Pixel, T_Calc, MODE_VAL>& filler, const planes_t& src,
+    const layout& src_layout, planes_t dst, const layout& dst_layout)
+{
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        if (p.process[i] != 1)
+            copy_plane(src, src_layout, dst, dst_layout, i);
+    }
+
+    fill_planes<T_Pixel>(p, filler, p.process, dst_layout.width, dst_layout.height, {0, 0}, dst, dst_layout);
+    return dst;
+}
+
+// The masked samples of the planes of the clip, one byte per sample.
+using masked_t = std::array<std::vector<uint8_t>, 4>;
+
+// A mask clip of one frame, greyscale or with the planes of the clip, of a random bit depth: a few runs of non-zero samples per row and
+// some rows entirely non-zero. `masked` gets the samples of the planes of the clip the mask covers.
+PClip random_mask(IScriptEnvironment& env, const params& p, const bool greyscale, std::mt19937& rng, masked_t& masked)
+{
+    VideoInfo vi{video_info(p)};
+    vi.bits = std::array{8, 16, 32}[random_int(rng, 0, 2)];
+
+    if (greyscale)
+    {
+        vi.num_components = 1;
+        vi.rgb = false;
+        vi.subsampling_w = vi.subsampling_h = 0;
+    }
+
+    PVideoFrame frame{env.NewVideoFrame(vi)};
+    masked_t mask_planes;
+
+    for (int j{0}; j < vi.num_components; ++j)
+    {
+        const int plane{(greyscale) ? PLANAR_Y : plane_order(p)[j]};
+        const auto [width, height]{plane_size(p, j)};
+        mask_planes[j].assign(static_cast<size_t>(width) * height, 0);
+
+        for (int y{0}; y < height; ++y)
+        {
+            uint8_t* const row{frame->GetWritePtr(plane) + static_cast<ptrdiff_t>(y) * frame->GetPitch(plane)};
+            uint8_t* const flags{mask_planes[j].data() + static_cast<size_t>(y) * width};
+
+            if (random_int(rng, 0, 9) == 0)
+                std::fill(flags, flags + width, 1);
+            else
+            {
+                for (int run{random_int(rng, 0, 3)}; run > 0; --run)
+                {
+                    const int begin{random_int(rng, 0, width - 1)};
+                    std::fill(flags + begin, flags + std::min(begin + random_int(rng, 1, 8), width), 1);
+                }
+            }
+
+            for (int x{0}; x < width; ++x)
+            {
+                if (vi.bits == 32)
+                {
+                    const float sample{(flags[x]) ? random_int(rng, 1, 100) / 100.0f : 0.0f};
+                    std::memcpy(row + x * 4, &sample, 4);
+                }
+                else if (vi.bits == 16)
+                {
+                    const uint16_t sample{static_cast<uint16_t>((flags[x]) ? random_int(rng, 1, 65535) : 0)};
+                    std::memcpy(row + x * 2, &sample, 2);
+                }
+                else
+                    row[x] = static_cast<uint8_t>((flags[x]) ? random_int(rng, 1, 255) : 0);
+            }
+        }
+    }
+
+    // A sample of a subsampled plane is masked when one of the samples of the greyscale mask it covers is.
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        const auto [width, height]{plane_size(p, i)};
+        const int shift_w{(greyscale && width != p.width) ? p.subsampling_w : 0};
+        const int shift_h{(greyscale && height != p.height) ? p.subsampling_h : 0};
+        const std::vector<uint8_t>& mask_plane{mask_planes[(greyscale) ? 0 : i]};
+        masked[i].assign(static_cast<size_t>(width) * height, 0);
+
+        for (int y{0}; y < height << shift_h; ++y)
+        {
+            for (int x{0}; x < width << shift_w; ++x)
+                masked[i][static_cast<size_t>(y >> shift_h) * width + (x >> shift_w)] |=
+                    mask_plane[static_cast<size_t>(y) * (width << shift_w) + x];
+        }
+    }
+
+    return new test_clip(vi, {frame}, false);
+}
+
+// The fill of the masked samples documented in the README: each run of masked samples of a row is filled from the nearest unmasked
+// samples of the row, the first half from the samples before it and the second half from the samples after it; a fully masked row
+// repeats the nearest row of its field that is not.
+template<typename T_Pixel>
+void fill_masked(const params& p, const masked_t& masked, planes_t& dst, const layout& l)
+{
+    // The sample that fills sample k of a half run, counted from the sample next to the run, with `clean` unmasked samples on that side.
+    const auto source{[&](const int k, const int clean) {
+        return (p.mode == 2) ? std::min(k, clean - 1) : ((p.mode == 3) ? std::min(k + 1, clean - 1) : 0);
+    }};
+    const int row_step{(p.interlaced) ? 2 : 1};
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        if (p.process[i] != 3)
+            continue;
+
+        const int width{l.width[i]};
+        const int height{l.height[i]};
+        const auto row{[&](const int y) { return reinterpret_cast<T_Pixel*>(dst[i].data() + y * l.stride[i]); }};
+        const auto is_masked{[&](const int x, const int y) { return masked[i][static_cast<size_t>(y) * width + x] != 0; }};
+        std::vector<uint8_t> full_rows(height);
+
+        for (int y{0}; y < height; ++y)
+        {
+            T_Pixel* const samples{row(y)};
+            int prev_end{0};
+            int x{0};
+
+            while (x < width)
+            {
+                if (!is_masked(x, y))
+                {
+                    ++x;
+                    continue;
+                }
+
+                const int begin{x};
+
+                while (x < width && is_masked(x, y))
+                    ++x;
+
+                const int end{x};
+                int next_begin{end};
+
+                while (next_begin < width && !is_masked(next_begin, y))
+                    ++next_begin;
+
+                const int before{begin - prev_end};
+                const int after{next_begin - end};
+                prev_end = end;
+
+                if (!before && !after)
+                {
+                    full_rows[y] = 1;
+                    continue;
+                }
+
+                const int count{end - begin};
+                const int num_before{(!after) ? count : ((!before) ? 0 : (count + 1) / 2)};
+
+                for (int k{0}; k < num_before; ++k)
+                    samples[begin + k] = samples[begin - 1 - source(k, before)];
+
+                for (int k{0}; k < count - num_before; ++k)
+                    samples[end - 1 - k] = samples[end + source(k, after)];
+            }
+        }
+
+        for (int y{0}; y < height; ++y)
+        {
+            if (!full_rows[y])
+                continue;
+
+            int above{y - row_step};
+            int below{y + row_step};
+
+            while (above >= 0 && full_rows[above])
+                above -= row_step;
+
+            while (below < height && full_rows[below])
+                below += row_step;
+
+            const int src_y{(below >= height || (above >= 0 && y - above <= below - y)) ? above : below};
+
+            if (src_y >= 0)
+                std::memcpy(row(y), row(src_y), static_cast<size_t>(width) * sizeof(T_Pixel));
+        }
+    }
+}
+
+struct fill_region
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    int mode;
+    std::array<int, 4> left{};
+    std::array<int, 4> top{};
+    std::array<int, 4> right{};
+    std::array<int, 4> bottom{};
+};
+
+// Calls f with the reference filler of a region: the mode of the region, the ts, ts_mode and fade_value of the filter, the planes whose
+// borders are filled.
+template<typename T_Pixel, typename T_Calc, typename F>
+void with_region_filler(const params& p, const fill_region& region, F&& f)
+{
+    std::array<int, 4> process{p.process};
+
+    for (int& value : process)
+        value = (value == 3) ? 3 : 1;
+
+    const auto call{[&]<int MODE_VAL>() {
+        f(reference::reference_filler<T_Pixel, T_Calc, MODE_VAL>{
+              region.left, region.top, region.right, region.bottom, process, p.ts, p.ts_mode, reference_fade_value<T_Calc>(p)},
+            process);
+    }};
+
+    switch (region.mode)
+    {
+    case 0:
+        return call.template operator()<0>();
+    case 1:
+        return call.template operator()<1>();
+    case 2:
+        return call.template operator()<2>();
+    case 3:
+        return call.template operator()<3>();
+    case 4:
+        return call.template operator()<4>();
+    case 5:
+        return call.template operator()<5>();
+    default:
+        return call.template operator()<6>();
+    }
+}
+
+// Sizes of the planes of a region.
+std::pair<std::array<int, 4>, std::array<int, 4>> region_planes(const params& p, const fill_region& region)
+{
+    std::array<int, 4> widths{};
+    std::array<int, 4> heights{};
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        const bool chroma{!p.rgb && (i == 1 || i == 2)};
+        widths[i] = (chroma) ? region.width >> p.subsampling_w : region.width;
+        heights[i] = (chroma) ? region.height >> p.subsampling_h : region.height;
+    }
+
+    return {widths, heights};
+}
+
+// Mode 7 after the fill of mode 1: the outermost rows and columns of the interior of every field are the median (or the rounded
+// average) of the ones of the last temporal_frames source frames, repeated over the borders. The top/bottom rows also repeat their first
+// and last sample over the corners.
+template<typename T_Pixel>
+void fill_temporal(const params& p, const int temporal_frames, const bool median, const std::vector<planes_t>& src,
+    const layout& src_layout, const int n, planes_t& dst, const layout& l)
+{
+    const int first_frame{std::max(n - temporal_frames + 1, 0)};
+    const int num_fields{(p.interlaced) ? 2 : 1};
+    std::vector<T_Pixel> values;
+
+    for (int i{0}; i < p.num_planes; ++i)
+    {
+        if (p.process[i] != 3)
+            continue;
+
+        for (int field{0}; field < num_fields; ++field)
+        {
+            const int width{l.width[i]};
+            const int height{l.height[i] / num_fields};
+            const int left{p.left[i]};
+            const int top{p.top[i]};
+            const int right{p.right[i]};
+            const int bottom{p.bottom[i]};
+
+            if (width - left - right <= 0 || height - top - bottom <= 0)
+                continue;
+
+            const auto filtered{[&](const int y, const int x) {
+                values.clear();
+
+                for (int f{first_frame}; f <= n; ++f)
+                    values.push_back(reinterpret_cast<const T_Pixel*>(
+                        src[f][i].data() + static_cast<ptrdiff_t>(y * num_fields + field) * src_layout.stride[i])[x]);
+
+                if (median)
+                {
+                    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                    return values[values.size() / 2];
+                }
+
+                const int count{static_cast<int>(values.size())};
+
+                if constexpr (std::is_integral_v<T_Pixel>)
+                {
+                    const int sum{std::accumulate(values.begin(), values.end(), 0)};
+                    return static_cast<T_Pixel>((sum + count / 2) / count);
+                }
+                else
+                    return static_cast<T_Pixel>(std::accumulate(values.begin(), values.end(), 0.0f) / count);
+            }};
+            const auto row{[&](const int y) {
+                return reinterpret_cast<T_Pixel*>(dst[i].data() + static_cast<ptrdiff_t>(y * num_fields + field) * l.stride[i]);
+            }};
+
+            for (int y{top}; y < height - bottom; ++y)
+            {
+                if (left)
+                    std::fill_n(row(y), left, filtered(y, left));
+
+                if (right)
+                    std::fill_n(row(y) + width - right, right, filtered(y, width - right - 1));
+            }
+
+            for (const bool is_top : {true, false})
+            {
+                const int edge_y{(is_top) ? top : height - bottom - 1};
+
+                if (!((is_top) ? top : bottom))
+                    continue;
+
+                std::vector<T_Pixel> edge(width);
+
+                for (int x{left}; x < width - right; ++x)
+                    edge[x] = filtered(edge_y, x);
+
+                std::fill_n(edge.begin(), left, edge[left]);
+                std::fill_n(edge.begin() + width - right, right, edge[width - right - 1]);
+
+                for (int y{(is_top) ? 0 : height - bottom}; y < ((is_top) ? top : height); ++y)
+                    std::copy(edge.begin(), edge.end(), row(y));
+            }
+        }
+    }
+}
+
+// The part of a case that depends on its kind: more arguments of the filter, the changes of the source frames and of the expected
+// geometry, and the fill after the borders.
+template<typename T_Pixel, typename T_Calc>
+extras case_extras(IScriptEnvironment& env, params& p, std::vector<PVideoFrame>& src_frames, std::mt19937& rng)
+{
+    extras extra;
+    std::array<std::array<int, 4>*, 4> sides{&p.left, &p.top, &p.right, &p.bottom};
+
+    switch (p.kind)
+    {
+    case case_kind::greyscale_mask:
+    case case_kind::planar_mask:
+    {
+        masked_t masked;
+        extra.args.emplace_back("mask", random_mask(env, p, p.kind == case_kind::greyscale_mask, rng, masked));
+        extra.fill = [p, masked](planes_t& expected, const layout& l, int, const std::vector<planes_t>&, const layout&) {
+            fill_masked<T_Pixel>(p, masked, expected, l);
+        };
+        break;
+    }
+    case case_kind::regions:
+    {
+        // Whole samples of the subsampled planes and whole lines of both fields.
+        const int mod_w{1 << p.subsampling_w};
+        const int mod_h{((p.interlaced) ? 2 : 1) << p.subsampling_h};
+        std::vector<fill_region> regions;
+        std::vector<AVSValue> values;
+
+        for (int k{random_int(rng, 1, 2)}; k > 0; --k)
+        {
+            fill_region region{};
+            region.width = random_int(rng, 1, p.width / mod_w) * mod_w;
+            region.height = random_int(rng, 1, p.height / mod_h) * mod_h;
+            region.x = random_int(rng, 0, (p.width - region.width) / mod_w) * mod_w;
+            region.y = random_int(rng, 0, (p.height - region.height) / mod_h) * mod_h;
+            region.mode = random_int(rng, 0, 6);
+            const auto [widths, heights]{region_planes(p, region)};
+
+            for (int i{0}; i < p.num_planes; ++i)
+                random_plane_borders(rng, region.mode, p.ts, widths[i], heights[i] / ((p.interlaced) ? 2 : 1), region.left[i],
+                    region.top[i], region.right[i], region.bottom[i]);
+
+            with_region_filler<T_Pixel, T_Calc>(p, region, [&](const auto& filler, const std::array<int, 4>&) {
+                std::array<int, 4> field_heights{heights};
+
+                for (int& height : field_heights)
+                    height /= (p.interlaced) ? 2 : 1;
+
+                extra.valid = extra.valid && filler.valid(p.num_planes, widths, field_heights);
+            });
+
+            values.push_back(AVSValue(std::vector<AVSValue>{region.x, region.y, region.width, region.height, region.mode,
+                int_array(region.left, p.num_planes), int_array(region.top, p.num_planes), int_array(region.right, p.num_planes),
+                int_array(region.bottom, p.num_planes)}));
+            regions.push_back(region);
+        }
+
+        extra.args.emplace_back("regions", AVSValue(values));
+        // In the given order, in place.
+        extra.fill = [p, regions](planes_t& expected, const layout& l, int, const std::vector<planes_t>&, const layout&) {
+            for (const fill_region& region : regions)
+            {
+                const auto [widths, heights]{region_planes(p, region)};
+
+                with_region_filler<T_Pixel, T_Calc>(p, region, [&](const auto& filler, const std::array<int, 4>& process) {
+                    fill_planes<T_Pixel>(p, filler, process, widths, heights, {region.x, region.y}, expected, l);
+                });
+            }
+        };
+        break;
+    }
+    case case_kind::props:
+    {
+        constexpr const char* prop_names[]{"_FillBorders_Left", "_FillBorders_Top", "_FillBorders_Right", "_FillBorders_Bottom"};
+
+        // A side with a property gets no border from the parameter.
+        for (int side{0}; side < 4; ++side)
+        {
+            if (random_int(rng, 0, 3) == 0)
+            {
+                extra.borders[side] = *sides[side];
+                continue;
+            }
+
+            for (PVideoFrame& frame : src_frames)
+                frame->props.int_props[prop_names[side]].assign(sides[side]->begin(), sides[side]->begin() + p.num_planes);
+        }
+
+        extra.args.emplace_back("borders_from_props", true);
+        return extra;
+    }
+    case case_kind::autodetect:
+    {
+        // Dark columns and rows around a bright first plane, up to the quarter of the plane that is measured. The average of a bright
+        // row or column is above the default autodetect_thr (24 in 8-bit scale), the one of a dark row or column below.
+        const int plane{plane_order(p)[0]};
+        std::array<int, 4> borders{random_int(rng, 0, p.width / 4), random_int(rng, 0, p.height / 4), random_int(rng, 0, p.width / 4),
+            random_int(rng, 0, p.height / 4)};
+
+        // The borders bumped to ts must leave an interior in every plane.
+        if (p.mode == 4 && p.ts > 0)
+        {
+            for (int i{0}; i < p.num_planes; ++i)
+            {
+                const auto [width, height]{plane_size(p, i)};
+
+                if (width <= 2 * p.ts || height / ((p.interlaced) ? 2 : 1) <= 2 * p.ts)
+                    borders = {};
+            }
+        }
+
+        // The fields get the same sizes.
+        if (p.interlaced)
+        {
+            borders[1] &= ~1;
+            borders[3] &= ~1;
+        }
+
+        for (PVideoFrame& frame : src_frames)
+        {
+            for (int y{0}; y < p.height; ++y)
+            {
+                T_Pixel* const row{
+                    reinterpret_cast<T_Pixel*>(frame->GetWritePtr(plane) + static_cast<ptrdiff_t>(y) * frame->GetPitch(plane))};
+
+                for (int x{0}; x < p.width; ++x)
+                {
+                    const bool dark{x < borders[0] || y < borders[1] || x >= p.width - borders[2] || y >= p.height - borders[3]};
+
+                    if constexpr (std::is_floating_point_v<T_Pixel>)
+                        row[x] = (dark) ? std::uniform_real_distribution<float>{0.0f, 8.0f / 255}(rng)
+                                        : std::uniform_real_distribution<float>{0.5f, 1.0f}(rng);
+                    else
+                        row[x] = static_cast<T_Pixel>(
+                            (dark) ? random_int(rng, 0, 8 << (p.bits - 8)) : random_int(rng, 128 << (p.bits - 8), (1 << p.bits) - 1));
+                }
+            }
+        }
+
+        // The subsampled planes are rounded up, transient smoothing needs borders of at least ts.
+        for (int side{0}; side < 4; ++side)
+        {
+            const int value{(p.interlaced && (side == 1 || side == 3)) ? borders[side] / 2 : borders[side]};
+            const int shift{(side == 0 || side == 2) ? p.subsampling_w : p.subsampling_h};
+
+            for (int i{0}; i < p.num_planes; ++i)
+            {
+                int& size{(*sides[side])[i]};
+                size = (!p.rgb && (i == 1 || i == 2)) ? (value + (1 << shift) - 1) >> shift : value;
+
+                if (p.mode == 4 && p.ts > 0 && size > 0 && size < p.ts)
+                    size = p.ts;
+            }
+        }
+
+        extra.args.emplace_back("autodetect", true);
+        return extra;
+    }
+    case case_kind::temporal:
+    {
+        const int temporal_frames{random_int(rng, 1, 6)};
+        const bool median{random_int(rng, 0, 1) == 1};
+        extra.args.emplace_back("temporal_frames", temporal_frames);
+        extra.args.emplace_back("temporal_median", median);
+        extra.fill = [p, temporal_frames, median](planes_t& expected, const layout& l, const int n, const std::vector<planes_t>& src,
+                         const layout& src_layout) {
+            fill_temporal<T_Pixel>(p, temporal_frames, median, src, src_layout, n, expected, l);
+        };
+        break;
+    }
+    default:
+        break;
+    }
+
+    for (int side{0}; side < 4; ++side)
+        extra.borders[side] = *sides[side];
+
+    return extra;
+}
+
+bool compare(const planes_t& expected, const planes_t& actual, const layout& l, const params& p, const char* path, const int opt,
+    const int threads, const int n)
+{
+    for (int i{0}; i < l.num_planes; ++i)
+    {
+        const auto mismatch{std::mismatch(expected[i].begin(), expected[i].end(), actual[i].begin())};
+
+        if (mismatch.first == expected[i].end())
+            continue;
+
+        const ptrdiff_t offset{mismatch.first - expected[i].begin()};
+        std::printf("FAIL %s, opt %d, threads %d, frame %d: plane %d differs at x %d, y %d\n    %s\n", path, opt, threads, n, i,
+            static_cast<int>(offset % l.stride[i] / l.sample_size), static_cast<int>(offset / l.stride[i]), describe(p).c_str());
+        return false;
+    }
+
+    return true;
+}
+
+template<typename T_Pixel, typename T_Calc, int MODE_VAL>
+void run_case(IScriptEnvironment& env, params p, const int max_opt, std::mt19937& rng, counters& count)
+{
+    // Mode 7 gets several frames.
+    VideoInfo vi{video_info(p)};
+    vi.num_frames = (MODE_VAL == 7) ? random_int(rng, 2, 8) : 1;
+    env.frame_padding = random_int(rng, 0, 40) * 4;
+    std::vector<PVideoFrame> src_frames;
+
+    for (int n{0}; n < vi.num_frames; ++n)
+    {
+        src_frames.push_back(env.NewVideoFrame(vi));
+        randomize_frame<T_Pixel>(p, src_frames.back(), rng);
+    }
+
+    const extras extra{case_extras<T_Pixel, T_Calc>(env, p, src_frames, rng)};
+    const reference::reference_filler<T_Pixel, T_Calc, (MODE_VAL == 7) ? 1 : MODE_VAL> filler{
+        p.left, p.top, p.right, p.bottom, p.process, p.ts, p.ts_mode, reference_fade_value<T_Calc>(p)};
+
+    // The new frames of the filter get another padding and a pattern that no fill writes by chance.
+    env.frame_padding = random_int(rng, 0, 40) * 4;
+
+    const layout src_layout{frame_layout(p, src_frames[0])};
+    std::vector<planes_t> src;
+    // The planes the reference fills: the planes of the frames, or the components of the packed frames.
+    layout planar_layout{src_layout};
+    std::vector<planes_t> src_planar;
+
+    for (const PVideoFrame& frame : src_frames)
+    {
+        src.push_back(frame_planes(p, frame));
+        src_planar.push_back((p.packed_bytes) ? unpack<T_Pixel>(p, src.back(), src_layout, planar_layout) : src.back());
+    }
+
+    std::array<int, 4> field_heights{planar_layout.height};
+
+    for (int& height : field_heights)
+        height /= (p.interlaced) ? 2 : 1;
+
+    const bool valid{filler.valid(p.num_planes, planar_layout.width, field_heights) && extra.valid};
+    // Out of order too, for the edges kept by mode 7.
+    std::vector<int> order(vi.num_frames);
+    std::iota(order.begin(), order.end(), 0);
+
+    if (random_int(rng, 0, 1))
+        std::shuffle(order.begin(), order.end(), rng);
+
+    for (int opt{0}; opt <= max_opt; ++opt)
+    {
+        for (const int threads : {1, 4})
+        {
+            for (const bool in_place : {false, true})
+            {
+                try
+                {
+                    const PClip clip{fill_borders(env, p, extra, new test_clip(vi, src_frames, in_place), opt, threads)};
+                    // The sizes read from the frames or detected are checked by GetFrame, the other ones by the constructor.
+                    const bool frame_sizes{p.kind == case_kind::props || p.kind == case_kind::autodetect};
+
+                    if (!valid && !frame_sizes)
+                    {
+                        std::printf("FAIL the filter accepts an invalid geometry\n    %s\n", describe(p).c_str());
+                        ++count.failures;
+                        return;
+                    }
+
+                    for (const int n : order)
+                    {
+                        const PVideoFrame out_frame{clip->GetFrame(n, &env)};
+
+                        if (!valid)
+                        {
+                            std::printf("FAIL the filter accepts an invalid geometry\n    %s\n", describe(p).c_str());
+                            ++count.failures;
+                            return;
+                        }
+
+                        const layout out_layout{frame_layout(p, out_frame)};
+                        // In place, or when the source frame is returned as is, the output frame starts as a copy of the source frame.
+                        const bool from_source{in_place || out_frame.operator->() == src_frames[n].operator->()};
+                        const layout& expected_layout{(from_source) ? src_layout : out_layout};
+                        planes_t expected;
+
+                        if (from_source)
+                            expected = src[n];
+                        else
+                        {
+                            for (int i{0}; i < out_layout.num_planes; ++i)
+                                expected[i].assign(static_cast<size_t>(out_layout.stride[i]) * out_layout.height[i], env.frame_fill);
+                        }
+
+                        // The rows of a packed frame are copied whole, then its components are filled.
+                        if (p.packed_bytes)
+                        {
+                            copy_plane(src[n], src_layout, expected, expected_layout, 0);
+                            pack<T_Pixel>(p, reference_frame(p, filler, src_planar[n], planar_layout, src_planar[n], planar_layout),
+                                planar_layout, expected, expected_layout);
+                        }
+                        else
+                            expected = reference_frame(p, filler, src[n], src_layout, std::move(expected), expected_layout);
+
+                        if (extra.fill)
+                            extra.fill(expected, expected_layout, n, src, src_layout);
+
+                        if (!compare(expected, frame_planes(p, out_frame), out_layout, p, (in_place) ? "in place" : "new frame", opt,
+                                threads, n))
+                            ++count.failures;
+                    }
+                }
+                catch (const AvisynthError& error)
+                {
+                    if (valid)
+                    {
+                        std::printf("FAIL the filter rejects a valid geometry (%s)\n    %s\n", error.msg, describe(p).c_str());
+                        ++count.failures;
+                    }
+                    else
+                        ++count.rejected[p.mode];
+
+                    return;
+                }
+            }
+        }
+    }
+
+    ++count.compared[p.mode];
+    ++count.compared_kinds[static_cast<int>(p.kind)];
+}
+
+template<typename T_Pixel, typename T_Calc>
+void run_case(IScriptEnvironment& env, const params& p, const int max_opt, std::mt19937& rng, counters& count)
+{
+    switch (p.mode)
+    {
+    case 0:
+        return run_case<T_Pixel, T_Calc, 0>(env, p, max_opt, rng, count);
+    case 1:
+        return run_case<T_Pixel, T_Calc, 1>(env, p, max_opt, rng, count);
+    case 2:
+        return run_case<T_Pixel, T_Calc, 2>(env, p, max_opt, rng, count);
+    case 3:
+        return run_case<T_Pixel, T_Calc, 3>(env, p, max_opt, rng, count);
+    case 4:
+        return run_case<T_Pixel, T_Calc, 4>(env, p, max_opt, rng, count);
+    case 5:
+        return run_case<T_Pixel, T_Calc, 5>(env, p, max_opt, rng, count);
+    case 6:
+        return run_case<T_Pixel, T_Calc, 6>(env, p, max_opt, rng, count);
+    default:
+        return run_case<T_Pixel, T_Calc, 7>(env, p, max_opt, rng, count);
+    }
+}
+
+// The highest opt the CPU supports.
+int max_opt_level(IScriptEnvironment& env)
+{
+    VideoInfo vi;
+    vi.width = vi.height = 16;
+    vi.num_components = 1;
+    const PClip clip{new test_clip(vi, {env.NewVideoFrame(vi)}, false)};
+
+    for (int opt{3}; opt > 0; --opt)
+    {
+        try
+        {
+            env.call("FillBorders", {{nullptr, clip}, {"opt", opt}});
+            return opt;
+        }
+        catch (const AvisynthError&)
+        {
+        }
+    }
+
+    return 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int num_cases{(argc > 1) ? std::atoi(argv[1]) : 3000};
+    const unsigned seed{(argc > 2) ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 20240615u};
+
+    IScriptEnvironment env;
+    AvisynthPluginInit3(&env, nullptr);
+
+    const int max_opt{max_opt_level(env)};
+    std::mt19937 rng{seed};
+    counters count;
+
+    for (int c{0}; c < num_cases && count.failures < 20; ++c)
+    {
+        const params p{random_params(rng, random_kind(rng))};
+
+        if (p.bits == 8)
+            run_case<uint8_t, int>(env, p, max_opt, rng, count);
+        else if (p.bits == 32)
+            run_case<float, float>(env, p, max_opt, rng, count);
+        else
+            run_case<uint16_t, int>(env, p, max_opt, rng, count);
+    }
+
+    for (int mode{0}; mode < 8; ++mode)
+        std::printf("mode %d: %d geometries compared, %d rejected\n", mode, count.compared[mode], count.rejected[mode]);
+
+    for (int kind{0}; kind < static_cast<int>(case_kind::count); ++kind)
+        std::printf("%s: %d cases compared\n", case_kind_names[kind], count.compared_kinds[kind]);
+
+    std::printf("%s (seed %u, opt 0..%d)\n", (count.failures) ? "FAILED" : "passed", seed, max_opt);
+    return (count.failures) ? 1 : 0;
+}
@@ -0,0 +1,536 @@
+// Stand-in for the parts of avisynth.h that src/FillBorders.cpp uses, so fillborders_bench and fillborders_tests run the filter
+// without AviSynth+. Frames are heap buffers with 64-byte aligned rows, frame properties are integer arrays, and the functions
+// registered with AddFunction can be called back with named arguments (Invoke, call). Only the formats FillBorders accepts are
+// described by VideoInfo.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVS_FORCEINLINE __forceinline
+#else
+#define AVS_FORCEINLINE inline __attribute__((always_inline))
+#define __stdcall
+#define __cdecl
+#define __declspec(x)
+#endif
+
+#define AVS_RESTRICT __restrict
+
+enum
+{
+    PLANAR_Y = 1 << 0,
+    PLANAR_U = 1 << 1,
+    PLANAR_V = 1 << 2,
+    PLANAR_A = 1 << 4,
+    PLANAR_R = 1 << 5,
+    PLANAR_G = 1 << 6,
+    PLANAR_B = 1 << 7
+};
+
+enum
+{
+    CPUF_SSE2 = 0x10,
+    CPUF_SSE4_1 = 0x400,
+    CPUF_AVX = 0x800,
+    CPUF_AVX2 = 0x2000,
+    CPUF_AVX512F = 0x100000,
+    CPUF_AVX512BW = 0x800000
+};
+
+enum
+{
+    CACHE_GET_MTMODE = 0x1001,
+    MT_NICE_FILTER = 1
+};
+
+enum
+{
+    PROPAPPENDMODE_REPLACE = 0,
+    PROPAPPENDMODE_APPEND = 1
+};
+
+struct AvisynthError
+{
+    const char* msg;
+};
+
+struct AVS_Linkage
+{
+};
+
+struct VideoInfo
+{
+    int width{};
+    int height{};
+    int num_frames{1};
+    int bits{8};
+    int num_components{3};
+    int subsampling_w{};
+    int subsampling_h{};
+    bool rgb{};
+    // Packed formats: 0 for planar, otherwise the bytes of one pixel (2 for YUY2, 3/4/6/8 for RGB24/32/48/64).
+    int packed_bytes{};
+    bool field_based{};
+
+    bool IsPlanar() const noexcept { return !packed_bytes; }
+    bool IsY() const noexcept { return !rgb && num_components == 1; }
+    bool IsRGB() const noexcept { return rgb; }
+    bool IsYUY2() const noexcept { return !rgb && packed_bytes == 2; }
+    bool IsRGB24() const noexcept { return rgb && packed_bytes == 3; }
+    bool IsRGB32() const noexcept { return rgb && packed_bytes == 4; }
+    bool IsRGB48() const noexcept { return rgb && packed_bytes == 6; }
+    bool IsRGB64() const noexcept { return rgb && packed_bytes == 8; }
+    bool IsFieldBased() const noexcept { return field_based; }
+    int NumComponents() const noexcept { return num_components; }
+    int BitsPerComponent() const noexcept { return bits; }
+    int ComponentSize() const noexcept { return (bits == 8) ? 1 : ((bits == 32) ? 4 : 2); }
+
+    int GetPlaneWidthSubsampling(const int plane) const noexcept
+    {
+        return (plane == PLANAR_U || plane == PLANAR_V) ? subsampling_w : 0;
+    }
+
+    int GetPlaneHeightSubsampling(const int plane) const noexcept
+    {
+        return (plane == PLANAR_U || plane == PLANAR_V) ? subsampling_h : 0;
+    }
+
+    // The planes of a frame (a single one, 0, for the packed formats).
+    std::vector<int> planes() const
+    {
+        if (!IsPlanar())
+            return {0};
+
+        std::vector<int> list{(rgb) ? std::vector<int>{PLANAR_R, PLANAR_G, PLANAR_B} : std::vector<int>{PLANAR_Y, PLANAR_U, PLANAR_V}};
+        list.resize((rgb || num_components > 1) ? 3 : 1);
+
+        if (num_components == 4)
+            list.push_back(PLANAR_A);
+
+        return list;
+    }
+};
+
+class AVSMap
+{
+public:
+    std::map<std::string, std::vector<int64_t>> int_props;
+};
+
+class VideoFrame
+{
+    struct plane
+    {
+        std::vector<uint8_t> data;
+        int pitch;
+        int row_size;
+        int height;
+    };
+
+    std::map<int, plane> m_planes;
+
+    // Buffers of deleted frames, reused like the frame cache of AviSynth+ does (no page faults in the timings of the benchmark).
+    static std::vector<uint8_t> take_buffer(const size_t size)
+    {
+        std::lock_guard<std::mutex> lock{pool_mutex()};
+        std::multimap<size_t, std::vector<uint8_t>>& buffers{pool()};
+        const auto it{buffers.find(size)};
+
+        if (it == buffers.end())
+            return std::vector<uint8_t>(size);
+
+        std::vector<uint8_t> buffer{std::move(it->second)};
+        buffers.erase(it);
+        return buffer;
+    }
+
+    static std::multimap<size_t, std::vector<uint8_t>>& pool()
+    {
+        static std::multimap<size_t, std::vector<uint8_t>> buffers;
+        return buffers;
+    }
+
+    static std::mutex& pool_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+public:
+    std::atomic<int> refcount{0};
+    AVSMap props;
+
+    // Rows of row_size rounded up to 64 bytes plus `padding` bytes, every byte set to `fill` (left as is for a negative fill).
+    VideoFrame(const VideoInfo& vi, const int padding, const int fill)
+    {
+        for (const int p : vi.planes())
+        {
+            const int width{((vi.IsPlanar()) ? vi.width >> vi.GetPlaneWidthSubsampling(p) : vi.width) *
+                            ((vi.IsPlanar()) ? vi.ComponentSize() : vi.packed_bytes)};
+            const int height{vi.height >> vi.GetPlaneHeightSubsampling(p)};
+            const int pitch{(width + 63) / 64 * 64 + padding};
+            m_planes[p] = {take_buffer(static_cast<size_t>(pitch) * height), pitch, width, height};
+
+            if (fill >= 0)
+                std::fill(m_planes[p].data.begin(), m_planes[p].data.end(), static_cast<uint8_t>(fill));
+        }
+    }
+
+    VideoFrame(const VideoFrame& other) : props(other.props)
+    {
+        for (const auto& [p, pl] : other.m_planes)
+        {
+            m_planes[p] = {take_buffer(pl.data.size()), pl.pitch, pl.row_size, pl.height};
+            std::copy(pl.data.begin(), pl.data.end(), m_planes[p].data.begin());
+        }
+    }
+
+    ~VideoFrame()
+    {
+        std::lock_guard<std::mutex> lock{pool_mutex()};
+
+        for (auto& [p, pl] : m_planes)
+            pool().emplace(pl.data.size(), std::move(pl.data));
+    }
+
+    // Like AviSynth, PLANAR_Y and 0 are the same plane of a frame.
+    plane& get(const int p)
+    {
+        const auto it{m_planes.find(p)};
+        return (it != m_planes.end()) ? it->second : m_planes.begin()->second;
+    }
+
+    int GetPitch(const int p = 0) { return get(p).pitch; }
+    int GetRowSize(const int p = 0) { return get(p).row_size; }
+    int GetHeight(const int p = 0) { return get(p).height; }
+    const uint8_t* GetReadPtr(const int p = 0) { return get(p).data.data(); }
+    uint8_t* GetWritePtr(const int p = 0) { return get(p).data.data(); }
+    bool IsWritable() const noexcept { return refcount == 1; }
+};
+
+class PVideoFrame
+{
+    VideoFrame* m_frame{};
+
+    void release() noexcept
+    {
+        if (m_frame && --m_frame->refcount == 0)
+            delete m_frame;
+    }
+
+public:
+    PVideoFrame() = default;
+
+    PVideoFrame(VideoFrame* frame) : m_frame(frame)
+    {
+        if (m_frame)
+            ++m_frame->refcount;
+    }
+
+    PVideoFrame(const PVideoFrame& other) : PVideoFrame(other.m_frame) {}
+
+    PVideoFrame& operator=(const PVideoFrame& other)
+    {
+        if (other.m_frame)
+            ++other.m_frame->refcount;
+
+        release();
+        m_frame = other.m_frame;
+        return *this;
+    }
+
+    ~PVideoFrame() { release(); }
+
+    VideoFrame* operator->() const noexcept { return m_frame; }
+    explicit operator bool() const noexcept { return m_frame; }
+};
+
+class IScriptEnvironment;
+
+class IClip
+{
+public:
+    std::atomic<int> refcount{0};
+
+    virtual ~IClip() = default;
+    virtual PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) = 0;
+    virtual const VideoInfo& __stdcall GetVideoInfo() = 0;
+    virtual int __stdcall SetCacheHints(int, int) { return 0; }
+};
+
+class PClip
+{
+    IClip* m_clip{};
+
+    void release() noexcept
+    {
+        if (m_clip && --m_clip->refcount == 0)
+            delete m_clip;
+    }
+
+public:
+    PClip() = default;
+
+    PClip(IClip* clip) : m_clip(clip)
+    {
+        if (m_clip)
+            ++m_clip->refcount;
+    }
+
+    PClip(const PClip& other) : PClip(other.m_clip) {}
+
+    PClip& operator=(const PClip& other)
+    {
+        if (other.m_clip)
+            ++other.m_clip->refcount;
+
+        release();
+        m_clip = other.m_clip;
+        return *this;
+    }
+
+    ~PClip() { release(); }
+
+    IClip* operator->() const noexcept { return m_clip; }
+    explicit operator bool() const noexcept { return m_clip; }
+};
+
+class AVSValue
+{
+    char m_type{'v'};
+    int m_int{};
+    float m_float{};
+    bool m_bool{};
+    const char* m_string{};
+    PClip m_clip;
+    std::vector<AVSValue> m_array;
+
+public:
+    AVSValue() = default;
+    AVSValue(const int value) : m_type('i'), m_int(value) {}
+    AVSValue(const float value) : m_type('f'), m_float(value) {}
+    AVSValue(const double value) : m_type('f'), m_float(static_cast<float>(value)) {}
+    AVSValue(const bool value) : m_type('b'), m_bool(value) {}
+    AVSValue(const char* value) : m_type('s'), m_string(value) {}
+    AVSValue(const PClip& value) : m_type('c'), m_clip(value) {}
+    AVSValue(IClip* value) : m_type('c'), m_clip(value) {}
+    AVSValue(const AVSValue* values, const int size) : m_type('a'), m_array(values, values + size) {}
+    AVSValue(std::vector<AVSValue> values) : m_type('a'), m_array(std::move(values)) {}
+
+    bool Defined() const noexcept { return m_type != 'v'; }
+    bool IsInt() const noexcept { return m_type == 'i'; }
+    bool IsFloat() const noexcept { return m_type == 'f' || m_type == 'i'; }
+    bool IsBool() const noexcept { return m_type == 'b'; }
+    bool IsString() const noexcept { return m_type == 's'; }
+    bool IsClip() const noexcept { return m_type == 'c'; }
+    bool IsArray() const noexcept { return m_type == 'a'; }
+    int ArraySize() const noexcept { return (IsArray()) ? static_cast<int>(m_array.size()) : 1; }
+    const AVSValue& operator[](const int index) const { return (IsArray()) ? m_array[index] : *this; }
+
+    int AsInt() const noexcept { return m_int; }
+    int AsInt(const int def) const noexcept { return (IsInt()) ? m_int : def; }
+    bool AsBool(const bool def) const noexcept { return (IsBool()) ? m_bool : def; }
+    float AsFloatf(const float def) const noexcept { return (m_type == 'f') ? m_float : ((IsInt()) ? m_int : def); }
+    double AsFloat(const double def) const noexcept { return AsFloatf(static_cast<float>(def)); }
+    const char* AsString(const char* def = nullptr) const noexcept { return (IsString()) ? m_string : def; }
+    PClip AsClip() const { return m_clip; }
+};
+
+class IScriptEnvironment
+{
+    struct function
+    {
+        std::vector<std::pair<std::string, bool>> params; // name ("" for unnamed), array type (i*, i+)
+        AVSValue (*apply)(AVSValue args, void* user_data, IScriptEnvironment* env);
+        void* user_data;
+    };
+
+    std::map<std::string, function> m_functions;
+
+    static int detect_cpu_flags() noexcept
+    {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        return ((__builtin_cpu_supports("sse2")) ? CPUF_SSE2 : 0) | ((__builtin_cpu_supports("sse4.1")) ? CPUF_SSE4_1 : 0) |
+               ((__builtin_cpu_supports("avx")) ? CPUF_AVX : 0) | ((__builtin_cpu_supports("avx2")) ? CPUF_AVX2 : 0) |
+               ((__builtin_cpu_supports("avx512f")) ? CPUF_AVX512F : 0) | ((__builtin_cpu_supports("avx512bw")) ? CPUF_AVX512BW : 0);
+#else
+        return 0;
+#endif
+    }
+
+public:
+    // The flags of the CPU; clear some to test the fallbacks.
+    int cpu_flags{detect_cpu_flags()};
+    // Extra bytes at the end of the rows of the next new frames, and their initial value (-1: whatever the reused buffer holds).
+    int frame_padding{};
+    int frame_fill{0xA5};
+
+    [[noreturn]] void ThrowError(const char* format, ...)
+    {
+        thread_local char message[1024];
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+        throw AvisynthError{message};
+    }
+
+    int GetCPUFlags() const noexcept { return cpu_flags; }
+    bool FunctionExists(const char*) const noexcept { return true; }
+
+    PVideoFrame NewVideoFrame(const VideoInfo& vi, int = 64) { return new VideoFrame(vi, frame_padding, frame_fill); }
+
+    PVideoFrame NewVideoFrameP(const VideoInfo& vi, const PVideoFrame* prop_src, int = 64)
+    {
+        PVideoFrame frame{NewVideoFrame(vi)};
+        frame->props = (*prop_src)->props;
+        return frame;
+    }
+
+    void BitBlt(uint8_t* dstp, const int dst_pitch, const uint8_t* srcp, const int src_pitch, const int row_size, const int height)
+    {
+        for (int y{0}; y < height; ++y)
+            std::memcpy(dstp + static_cast<ptrdiff_t>(y) * dst_pitch, srcp + static_cast<ptrdiff_t>(y) * src_pitch, row_size);
+    }
+
+    const AVSMap* getFramePropsRO(const PVideoFrame& frame) const noexcept { return &frame->props; }
+    AVSMap* getFramePropsRW(PVideoFrame& frame) const noexcept { return &frame->props; }
+
+    int propNumElements(const AVSMap* map, const char* key) const
+    {
+        const auto it{map->int_props.find(key)};
+        return (it != map->int_props.end()) ? static_cast<int>(it->second.size()) : -1;
+    }
+
+    int64_t propGetInt(const AVSMap* map, const char* key, const int index, int* error) const
+    {
+        const auto it{map->int_props.find(key)};
+        const bool found{it != map->int_props.end() && index < static_cast<int>(it->second.size())};
+
+        if (error)
+            *error = !found;
+
+        return (found) ? it->second[index] : 0;
+    }
+
+    const int64_t* propGetIntArray(const AVSMap* map, const char* key, int* error) const
+    {
+        const auto it{map->int_props.find(key)};
+
+        if (error)
+            *error = it == map->int_props.end();
+
+        return (it != map->int_props.end()) ? it->second.data() : nullptr;
+    }
+
+    int propSetInt(AVSMap* map, const char* key, const int64_t value, const int append)
+    {
+        std::vector<int64_t>& values{map->int_props[key]};
+
+        if (append != PROPAPPENDMODE_APPEND)
+            values.clear();
+
+        values.push_back(value);
+        return 0;
+    }
+
+    int propSetIntArray(AVSMap* map, const char* key, const int64_t* values, const int size)
+    {
+        map->int_props[key].assign(values, values + size);
+        return 0;
+    }
+
+    // Parses the parameter string, e.g. "c[left]i*[mode]i".
+    void AddFunction(const char* name, const char* params, AVSValue (*apply)(AVSValue, void*, IScriptEnvironment*), void* user_data)
+    {
+        function f{{}, apply, user_data};
+
+        for (const char* p{params}; *p;)
+        {
+            std::string param_name;
+
+            if (*p == '[')
+            {
+                const char* end{std::strchr(p, ']')};
+                param_name.assign(p + 1, end);
+                p = end + 1;
+            }
+
+            ++p;
+            const bool is_array{*p == '*' || *p == '+'};
+            p += is_array;
+            f.params.emplace_back(param_name, is_array);
+        }
+
+        m_functions[name] = f;
+    }
+
+    AVSValue Invoke(const char* name, const AVSValue args, const char* const* arg_names = nullptr)
+    {
+        std::vector<std::pair<const char*, AVSValue>> named_args;
+
+        for (int i{0}; i < args.ArraySize(); ++i)
+            named_args.emplace_back((arg_names) ? arg_names[i] : nullptr, args[i]);
+
+        return call(name, named_args);
+    }
+
+    // Calls a function added with AddFunction: unnamed arguments (nullptr) first, then named ones in any order.
+    AVSValue call(const char* name, const std::vector<std::pair<const char*, AVSValue>>& args)
+    {
+        const auto it{m_functions.find(name)};
+
+        if (it == m_functions.end())
+            ThrowError("%s: no such function", name);
+
+        const function& f{it->second};
+        std::vector<AVSValue> values(f.params.size());
+        size_t next_unnamed{0};
+
+        for (const auto& [arg_name, value] : args)
+        {
+            size_t index{next_unnamed++};
+
+            if (arg_name)
+            {
+                for (index = 0; index < f.params.size() && f.params[index].first != arg_name; ++index)
+                    ;
+            }
+
+            if (index >= f.params.size())
+                ThrowError("%s: invalid argument %s", name, (arg_name) ? arg_name : "");
+
+            values[index] = (f.params[index].second && !value.IsArray()) ? AVSValue(&value, 1) : value;
+        }
+
+        return f.apply(AVSValue(std::move(values)), f.user_data, this);
+    }
+};
+
+class GenericVideoFilter : public IClip
+{
+protected:
+    PClip child;
+    VideoInfo vi;
+
+public:
+    GenericVideoFilter(const PClip& _child) : child(_child), vi(_child->GetVideoInfo()) {}
+
+    PVideoFrame __stdcall GetFrame(const int n, IScriptEnvironment* env) override { return child->GetFrame(n, env); }
+    const VideoInfo& __stdcall GetVideoInfo() override { return vi; }
+};